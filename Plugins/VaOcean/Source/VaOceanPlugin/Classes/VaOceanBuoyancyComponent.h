@@ -6,7 +6,7 @@
 #include "VaOceanBuoyancyComponent.generated.h"
 
 /**
- * Allows actor to swim in ocean
+ * Allows actor to swim in ocean. Wave reaction of all bodies is simulated by world buoyancy manager.
  */
 UCLASS(ClassGroup = Environment, editinlinenew, meta = (BlueprintSpawnableComponent))
 class UVaOceanBuoyancyComponent : public UMovementComponent
@@ -25,18 +25,33 @@ class UVaOceanBuoyancyComponent : public UMovementComponent
 	/** override center of mass offset, makes tweaking easier [uu] */
 	UPROPERTY(EditAnywhere, Category = VehicleSetup, AdvancedDisplay)
 	FVector COMOffset;
+
+	/** Displaced water volume, updated by hull buoyancy [uu^3] */
+	UPROPERTY(BlueprintReadOnly, Transient, Category = Hull)
+	float SubmergedVolume;
+
+	/** World centroid of displaced water, updated by hull buoyancy */
+	UPROPERTY(BlueprintReadOnly, Transient, Category = Hull)
+	FVector CenterOfBuoyancy;
+
+	/** Area of hull section by mean water plane, updated by hydrostatic tables [uu^2] */
+	UPROPERTY(BlueprintReadOnly, Transient, Category = Hull)
+	float WaterplaneArea;
 	
+	/** Wake ship sleeping at rest, e.g. when it's hit or its engine is started */
+	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
+	void WakeBuoyancy();
+
 	//Begin UActorComponent Interface
 	virtual void InitializeComponent() override;
-	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+	virtual void OnUnregister() override;
 	//End UActorComponent Interface
 
 protected:
-	/** Wave reaction */
-	virtual void PerformWaveReaction(float DeltaTime);
+	friend class FVaOceanBuoyancyManager;
 
-	/** Additional math */
-	static void GetAxes(FRotator A, FVector& X, FVector& Y, FVector& Z);
+	/** Static metacentric forces, X and Y are actor axes */
+	virtual void ApplyMetacentricForces(float DeltaTime, const FVector& X, const FVector& Y);
 
 	/** Ocean level at particular world position */
 	float GetOceanLevel(FVector& WorldLocation) const;
@@ -44,14 +59,17 @@ protected:
 	/** Ocean level difference (altitude) at desired position */
 	float GetAltitude(FVector& WorldLocation) const;
 
-	/** Ocean surface normal with altitude  */
-	FLinearColor GetSurfaceNormal(FVector& WorldLocation) const;
+	/** Unit ocean surface normal */
+	FVector GetSurfaceNormal(FVector& WorldLocation) const;
 
 	/** Horizontal wave velocity */
 	FVector GetWaveVelocity(FVector& WorldLocation) const;
 
-	/** How much to scale surface normal to get movement value */
-	int32 GetSurfaceWavesNum() const;
+	/** Hull length used to pick ocean physics LOD [uu] */
+	float GetHullLength() const;
+
+	/** Ocean level, surface normal and wave velocity for all locations in one call */
+	void GetOceanStateBatch(const TArray<FVector>& WorldLocations, TArray<float>& OutLevels, TArray<FVector>& OutNormals, TArray<FVector>& OutVelocities) const;
 
 protected:
 
@@ -71,6 +89,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category = WaveReaction)
 	float TensionDepthFactor;
 
+	/** Factor applied to dynamic pressure (0.515 * |V|^2) of water flowing around submerged dots */
+	UPROPERTY(EditAnywhere, Category = WaveReaction)
+	float WaveDragFactor;
+
 	/** Factor applied to calculate roll */
 	UPROPERTY(EditAnywhere, Category = WaveReaction)
 	float TensionTorqueFactor;
@@ -115,9 +137,139 @@ protected:
 	UPROPERTY(EditAnywhere, Category = WaveReaction)
 	float MinimumAltituteToReact;
 
+	/** How much FFT ocean cascades (from the longest waves) move the ship. 0 means all of them. */
+	UPROPERTY(EditAnywhere, Category = WaveReaction, meta = (ClampMin = "0"))
+	int32 MaxOceanCascades;
+
+	/** Waves shorter than hull don't move the ship, so ocean physics LOD is picked by it. 0 takes it from mesh bounds. [uu] */
+	UPROPERTY(EditAnywhere, Category = WaveReaction, meta = (ClampMin = "0"))
+	float HullLength;
+
+	/** Sample full resolution ocean, ignoring physics LODs */
+	UPROPERTY(EditAnywhere, Category = WaveReaction, AdvancedDisplay)
+	bool bFullResolutionOcean;
+
+protected:
+	//
+	// HULL BUOYANCY
+	//
+
+	/** Float by water pressure over hull mesh clipped by ocean surface instead of tension dots */
+	UPROPERTY(EditAnywhere, Category = Hull)
+	bool bHullBuoyancy;
+
+	/** Hull meshes from the most detailed one, LOD is picked by distance to the closest viewer */
+	UPROPERTY(EditAnywhere, Category = Hull)
+	TArray<FVaOceanHullLOD> HullLODs;
+
+	/** Density of water [kg/m^3] */
+	UPROPERTY(EditAnywhere, Category = Hull, meta = (ClampMin = "0"))
+	float WaterDensity;
+
+	/** Float by hydrostatic tables of the most detailed hull LOD against mean water plane, replaces metacentric forces. Cheap for AI ships. */
+	UPROPERTY(EditAnywhere, Category = Hull)
+	bool bHydrostaticBuoyancy;
+
+	/** Hull buoyancy switches to hydrostatic tables farther than this distance to the closest viewer, 0 disables it [uu] */
+	UPROPERTY(EditAnywhere, Category = Hull, meta = (ClampMin = "0"))
+	float HydrostaticDistance;
+
+protected:
+	//
+	// BUOYANCY LOD
+	//
+
+	/** Farther than this distance to the closest viewer ship is moved by single point heave/pitch/roll model, 0 disables it [uu] */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD, meta = (ClampMin = "0"))
+	float SinglePointDistance;
+
+	/** Farther than this distance to the closest viewer ship rides the surface without physics, keeping its course and speed, 0 disables it [uu] */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD, meta = (ClampMin = "0"))
+	float KinematicDistance;
+
+	/** Natural frequency of single point springs [Hz] */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD, meta = (ClampMin = "0"))
+	float SinglePointFrequency;
+
+	/** Damping ratio of single point springs, 1 is critical damping */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD, meta = (ClampMin = "0"))
+	float SinglePointDampingRatio;
+
+	/** How fast kinematic ship follows the surface */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD, meta = (ClampMin = "0"))
+	float KinematicInterpSpeed;
+
+	/** Ship that isn't controlled by player rides the surface without physics when it rests for a while */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD)
+	bool bSleepAtRest;
+
+	/** Ship rests below this speed [uu/s] */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD, meta = (ClampMin = "0"))
+	float RestSpeed;
+
+	/** Ship rests below this angular speed [deg/s] */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD, meta = (ClampMin = "0"))
+	float RestAngularSpeed;
+
+	/** How long ship should rest before sleeping [sec] */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD, meta = (ClampMin = "0"))
+	float RestTime;
+
+	/** Sleeping ship wakes up when ocean surface under it is tilted more than this [deg] */
+	UPROPERTY(EditAnywhere, Category = BuoyancyLOD, meta = (ClampMin = "0", ClampMax = "90"))
+	float WakeTiltAngle;
+
 private:
 
-	/** Cached ocean state actor to avoid search each frame with ship */
+	/** Ocean that covers the ship, updated when ship crosses region boundary */
 	TWeakObjectPtr<AVaOceanStateActor> OceanStateActor;
 
+	/** Cached ocean lookup of the ship location */
+	FVaOceanRegionHandle OceanRegion;
+
+	/** Find ocean region of the ship */
+	void UpdateOceanRegion();
+
+	/** Is body simulated by buoyancy manager */
+	bool bRegisteredBody;
+
+	/** Triangles of hull LODs, invalid ones are skipped */
+	TArray<FVaOceanHullMesh> HullMeshes;
+
+	/** Hull LOD for desired distance to viewer, NULL if there is no valid hull */
+	const FVaOceanHullMesh* GetHullMesh(float ViewDistance) const;
+
+	/** Tables of hull, shared by all bodies with the same mesh */
+	FVaOceanHydrostaticsPtr Hydrostatics;
+
+	/** Tables if they should be used at desired distance to viewer, NULL otherwise */
+	const FVaOceanHydrostatics* GetHydrostatics(float ViewDistance) const;
+
+	/** Buoyancy model of current frame and the one picked by distance only */
+	EVaOceanBuoyancyLOD::Type BuoyancyLOD;
+	EVaOceanBuoyancyLOD::Type DistanceLOD;
+
+	/** How long ship rests [sec] */
+	float RestTimer;
+
+	/** Was physics simulated before ship went kinematic */
+	bool bSimulatedBeforeKinematic;
+
+	/** Velocity kinematic ship keeps moving with, physics gets it back on switch: horizontal one [uu/s] and yaw rate (Z) [deg/s] */
+	FVector KinematicLinearVelocity;
+	FVector KinematicAngularVelocity;
+
+	/** Altitude of ship origin above mean ocean level measured by full buoyancy, coarse LODs keep it */
+	float RestAltitude;
+	bool bRestAltitudeValid;
+
+	/** Pick buoyancy LOD for this frame, physics is switched off and on when ship goes kinematic and back */
+	EVaOceanBuoyancyLOD::Type UpdateBuoyancyLOD(float ViewDistance, float DeltaTime);
+
+	/** Smooth measured altitude, so waves don't leak into it */
+	void UpdateRestAltitude(float Altitude, float DeltaTime);
+
+	/** Switch buoyancy model, sleeping ship doesn't keep its velocity */
+	void SetBuoyancyLOD(EVaOceanBuoyancyLOD::Type NewLOD, bool bSleeping);
+
 };
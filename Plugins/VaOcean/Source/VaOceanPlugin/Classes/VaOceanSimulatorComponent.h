@@ -0,0 +1,259 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+#include "VaOceanSimulatorComponent.generated.h"
+
+/**
+ * CPU version of the FFT ocean simulation (VaOcean_CS.usf + VaOcean_FFT.usf + VaOcean_VS_PS.usf).
+ * Produces displacement grids (one per spectrum cascade) that can be sampled by ocean state without GPU.
+ */
+UCLASS(ClassGroup = VaOcean, editinlinenew, meta = (BlueprintSpawnableComponent))
+class UVaOceanSimulatorComponent : public UActorComponent
+{
+	GENERATED_UCLASS_BODY()
+
+	//////////////////////////////////////////////////////////////////////////
+	// Simulation control
+
+	/**
+	 * Generate H(0) and Omega of all cascades for desired spectrum config. Async init loads or generates
+	 * tables on a worker thread, simulation starts with the first step after they are ready.
+	 */
+	void InitSpectrum(const FSpectrumData& InSpectrumConfig, bool bAsync = false);
+
+	/** Keep generated spectrum tables in Saved folder, so next start just maps them into memory */
+	UPROPERTY(EditAnywhere, Category = Simulation)
+	bool bCacheSpectrumTables;
+
+	/**
+	 * Change wind and amplitude without restarting the simulation. New H(0) is generated row by row
+	 * on worker threads and cross-faded in from BlendStartTime to BlendStartTime + BlendTime [ocean sec].
+	 * Configs with other wave vectors (cascades, seed, time scale) are re-initialized instead.
+	 */
+	void RetargetSpectrum(const FSpectrumData& InSpectrumConfig, float BlendStartTime, float BlendTime);
+
+	/** How much rows of each cascade spectrum are generated per frame during retarget */
+	UPROPERTY(EditAnywhere, Category = Simulation, meta = (ClampMin = "1"))
+	int32 SpectrumRowsPerFrame;
+
+	/** Run simulation step for all cascades: H(0) -> H(t) -> FFT -> displacement */
+	void UpdateDisplacementMap(float OceanTime);
+
+	/**
+	 * Tick launches the step of the next frame on a worker thread and publishes it at the start
+	 * of that frame, so simulation runs in parallel with the rest of the game thread work.
+	 * The step uses that one worker only, FFT lines are not spread further.
+	 */
+	UPROPERTY(EditAnywhere, Category = Simulation)
+	bool bAsyncSimulation;
+
+	/** Cascades limit, more of them cost more than one big patch */
+	static const int32 MaxCascades = 4;
+
+
+	/**
+	 * Physics samples the strongest spectrum components directly instead of FFT grids, no FFT is run then.
+	 * Much cheaper when only a few hundred points are sampled each frame (e.g. server with a few ships).
+	 */
+	UPROPERTY(EditAnywhere, Category = Simulation)
+	bool bSparseSampling;
+
+	/** How much spectrum components are kept by sparse sampling */
+	UPROPERTY(EditAnywhere, Category = Simulation, meta = (ClampMin = "4", ClampMax = "1024"))
+	int32 NumSparseWaves;
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Displacement grid access
+
+	/** Is displacement map calculated at least once (never in sparse sampling mode) */
+	bool IsSimulationReady() const;
+
+	/** Displacement (dx, dy, dz) at world position summed over all cascades. Bilinear filtered and tiled by patch length. */
+	FVector GetDisplacementAtLocation(const FVector& Location) const;
+
+	/** Number of simulated cascades, the first one has the longest waves */
+	int32 GetNumCascades() const;
+
+	/** Latest displacement grid of cascade (with gradient and velocity channels). Is never modified after publishing. */
+	FVaOceanGridPtr GetDisplacementGrid(int32 CascadeIndex = 0) const;
+
+	/** Number of band-limited physics LODs */
+	int32 GetNumPhysicsLODs() const;
+
+	/** Shortest wave length kept by physics LOD [uu] */
+	float GetPhysicsLODWaveLength(int32 PhysicsLOD) const;
+
+	/** Latest grids of all cascades kept by physics LOD, INDEX_NONE gives full resolution ones */
+	void GetCascadeGrids(int32 PhysicsLOD, TArray<FVaOceanGridPtr>& OutGrids) const;
+
+	/** Strongest spectrum components for sparse sampling, invalid if it's disabled or spectrum isn't ready */
+	FVaOceanWaveSetPtr GetSparseWaveSet() const;
+
+	/** Ocean clock time of the current displacement map */
+	float GetSimulationTime() const;
+
+	/** Spectrum config used to generate current H(0) */
+	const FSpectrumData& GetSpectrumConfig() const;
+
+	// Begin UActorComponent interface
+	virtual void InitializeComponent() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+	virtual void OnUnregister() override;
+	// End UActorComponent interface
+
+protected:
+	friend class FVaOceanSimulationStepTask;
+
+	/** Clock of owning ocean state actor (world time if there is no one) */
+	float GetOceanTime() const;
+
+	/** Clock speed of owning ocean state actor */
+	float GetOceanTimeScale() const;
+
+	/** Spectrum config used to generate current H(0) */
+	FSpectrumData SpectrumConfig;
+
+	/** Simulation data of one patch */
+	struct FCascade
+	{
+		/** Grid size and world size of the patch */
+		int32 Dim;
+		float PatchLength;
+
+		/** Band of wave numbers owned by cascade [rad/uu], zero max means no upper limit */
+		float MinWaveNumber;
+		float MaxWaveNumber;
+
+		/** Initial height field H(0) and angular frequencies */
+		FVaOceanSpectrumTablesPtr Tables;
+
+		/** H(0) being cross-faded in, Omega is the same as current one */
+		FVaOceanSpectrumTablesPtr TargetTables;
+
+		/** Frequency domain height H(t), Dim x Dim */
+		TArray<FVector2D> Ht;
+
+		/** Dx(t) + i * Dy(t), both transforms are real so they share one complex FFT */
+		TArray<FVector2D> Dxy;
+
+		/** Inverse FFT of Dim size */
+		FVaOceanFFT FFT;
+
+		/** Latest published displacement grid */
+		TSharedPtr<FVaOceanGrid, ESPMode::ThreadSafe> DisplacementGrid;
+
+		/** Previous grid, reused for the next step when nobody else holds it */
+		TSharedPtr<FVaOceanGrid, ESPMode::ThreadSafe> SpareGrid;
+
+		/** Grid made by the last step, waits to be published on game thread */
+		TSharedPtr<FVaOceanGrid, ESPMode::ThreadSafe> StepGrid;
+
+		/** Physics LOD uses this full resolution cascade as is, because it's small enough already */
+		int32 SharedCascade;
+
+		/** Nobody samples this cascade, so it isn't simulated */
+		bool bSkipSimulation;
+
+		FCascade() : SharedCascade(INDEX_NONE), bSkipSimulation(false) {}
+	};
+
+	/** Copy of cascades with short waves cut off */
+	struct FPhysicsLOD
+	{
+		/** Shortest wave length kept by LOD [uu] */
+		float MinWaveLength;
+
+		/** Band-limited cascades, the ones without long enough waves are dropped */
+		TArray<FCascade> Cascades;
+	};
+
+	/** Spectrum tables key of one cascade */
+	FVaOceanSpectrumTables::FKey MakeCascadeKey(const FSpectrumData& Config, const FCascade& Cascade, int32 CascadeIndex) const;
+
+	/** Prepare FFT and frequency domain buffers of one cascade */
+	void InitCascadeBuffers(FCascade& Cascade);
+
+	/** Take H(0) and Omega of the lowest frequencies from the source cascade */
+	void InitBandLimitedCascade(FCascade& Cascade, const FCascade& Source, int32 Dim);
+
+	/** Generate physics LODs from full resolution cascades */
+	void InitPhysicsLODs();
+
+	/** Generate and cross-fade the pending spectrum */
+	void UpdateSpectrumRetarget(float OceanTime);
+
+	/** Game thread part of the step: wait for spectrum tables and update retarget. Returns false if there is nothing to simulate. */
+	bool PrepareStep(float OceanTime);
+
+	/** Simulate all cascades, can be called from any thread */
+	void SimulateStep(float OceanTime);
+
+	/** Make grids of the last step visible to game thread */
+	void PublishStep(float OceanTime);
+
+	/** Wait for async step and publish its grids */
+	void FinishAsyncStep();
+
+	/** Pick the strongest spectrum components of all cascades */
+	void SelectSparseModes();
+
+	/** Build wave set of selected components from current (and target) H(0) */
+	void UpdateSparseWaveSet();
+
+	/** Simulation step of one cascade */
+	void UpdateCascade(FCascade& Cascade, float OceanTime);
+
+	/** Cascades sorted from the longest patch to the shortest one */
+	TArray<FCascade> Cascades;
+
+	/** Physics LODs from the finest one to the coarsest one */
+	TArray<FPhysicsLOD> PhysicsLODs;
+
+	/** Spectrum tables being loaded or generated */
+	FGraphEventRef SpectrumTablesTask;
+
+	/** Latest retarget request, it waits until the previous one is blended in */
+	bool bPendingRetarget;
+	FSpectrumData PendingSpectrumConfig;
+	float PendingBlendStartTime;
+	float PendingBlendTime;
+
+	/** Target tables of all cascades being generated row by row, empty when there is nothing to generate */
+	TArray<FVaOceanSpectrumTablesPtr> RetargetTables;
+	FGraphEventRef RetargetTask;
+
+	/** Spectrum that is being cross-faded in */
+	bool bBlendingSpectrum;
+	FSpectrumData TargetSpectrumConfig;
+	float BlendStartTime;
+	float BlendTime;
+
+	/** Weight of target H(0) for the current step */
+	float SpectrumBlendAlpha;
+
+	/** Spectrum component picked for sparse sampling: texel of cascade tables */
+	struct FSparseMode
+	{
+		int32 CascadeIndex;
+		int32 Index;
+	};
+
+	/** Components for sparse sampling, empty when they should be selected again */
+	TArray<FSparseMode> SparseModes;
+
+	/** Latest sparse wave set */
+	FVaOceanWaveSetPtr SparseWaveSet;
+
+	/** Step running on a worker thread and its ocean time */
+	FGraphEventRef StepTask;
+	float StepTime;
+
+	/** Ocean clock time of current displacement map */
+	float SimulationTime;
+
+	/** Number of finished simulation steps */
+	int32 NumSteps;
+
+};
@@ -22,7 +22,8 @@ class AVaOceanStateActor : public AActor
 #endif // WITH_EDITORONLY_DATA
 
 	/** Ocean simulation component (should be set in blueprint!) */
-	//UVaOceanSimulatorComponent* OceanSimulator;
+	UPROPERTY(Transient)
+	class UVaOceanSimulatorComponent* OceanSimulator;
 
 
 	//////////////////////////////////////////////////////////////////////////
@@ -47,30 +48,165 @@ class AVaOceanStateActor : public AActor
 	/** Get ocean level at desired position */
 	virtual float GetOceanLevelAtLocation(FVector& Location) const;
 
-	/** Get ocean surface normal at desired location */
-	virtual FLinearColor GetOceanSurfaceNormal(FVector& Location) const;
+	/** Get unit ocean surface normal at desired location */
+	virtual FVector GetOceanSurfaceNormal(FVector& Location) const;
 
-	/** Wave velocity is determined by UV change rate */
+	/** Wave velocity at desired location [m/sec] */
 	virtual FVector GetOceanWaveVelocity(FVector& Location) const;
 
-	/** How much waves are defined by normal map */
+	/** Sample ocean level, unit surface normal and wave velocity [m/sec] with one fetch */
+	virtual void GetOceanState(const FVector& Location, float& OutLevel, FVector& OutNormal, FVector& OutVelocity) const;
+
+	/**
+	 * Sample ocean level, surface normal and wave velocity for many locations in one call.
+	 * Normals and velocities have the same meaning as single location getters.
+	 */
+	virtual void GetOceanStateBatch(const TArray<FVector>& Locations, TArray<float>& OutLevels, TArray<FVector>& OutNormals, TArray<FVector>& OutVelocities) const;
+
+	/** How much waves are defined by ocean model (informational, normals are already unit length) */
 	virtual int32 GetOceanWavesNum() const;
 
+
+	//////////////////////////////////////////////////////////////////////////
+	// Ocean region
+
+	/** XY area covered by this ocean. Returns false if ocean is unbounded. */
+	bool GetRegionBounds(FBox2D& OutBounds) const;
+
+	/** Region with higher priority wins where regions overlap */
+	int32 GetRegionPriority() const;
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Ocean clock
+
+	/** Ocean time synchronized with server, all wave models are evaluated with it */
+	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
+	float GetOceanTime() const;
+
+	/** Change ocean time speed (server only) */
+	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
+	void SetOceanTimeScale(float TimeScale);
+
+	/** Ocean time speed relative to world time */
+	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
+	float GetOceanTimeScale() const;
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Sea state
+
+	/**
+	 * Change wind and wave amplitude of spectrum during the match (server only).
+	 * New waves are cross-faded in over BlendTime [ocean sec] on all machines.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
+	void SetSeaState(FVector2D WindDirection, float WindSpeed, float WaveAmplitude, float BlendTime);
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Ocean snapshot
+
+	/**
+	 * Latest published ocean state. Snapshot is immutable, so it can be kept
+	 * and sampled from any thread while the next one is being prepared.
+	 */
+	FVaOceanSnapshotPtr GetOceanSnapshot() const;
+
+	/** Build and publish new snapshot (is called each tick) */
+	void UpdateOceanSnapshot();
+
 	// Begin AActor interface
 	virtual void PreInitializeComponents() override;
 	virtual void PostInitializeComponents() override;
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void Destroyed() override;
 	// End AActor interface
 
+	// Begin UObject interface
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif // WITH_EDITOR
+	// End UObject interface
+
 protected:
+	/** Fill snapshot with current ocean state. Ocean models override it to add their own data. */
+	virtual void BuildOceanSnapshot(FVaOceanSnapshot& OutSnapshot) const;
+
+	/** Current snapshot or a temporary one if nothing was published yet */
+	FVaOceanSnapshotPtr GetSnapshotForSampling() const;
+
 	/** Ocean spectrum data */
 	UPROPERTY(EditDefaultsOnly, Category = Config)
 	FSpectrumData SpectrumConfig;
 
+private:
+	/** Local world time that corresponds to server base time */
+	float LocalClockBaseTime;
+
+	/** Server world time of last clock resync */
+	float LastClockSyncTime;
+
+	/** How much time bases were received by client */
+	int32 NumClockUpdates;
+
+	/** Latest published snapshot */
+	FVaOceanSnapshotPtr CurrentSnapshot;
+
+	/** Guards snapshot pointer swap */
+	mutable FCriticalSection SnapshotCriticalSection;
+
 protected:
 
 	UPROPERTY(EditAnywhere, Category = OceanSetup)
 	float GlobalOceanLevel;
 
+	/** Ocean covers the whole world (except bounded regions with higher priority) */
+	UPROPERTY(EditAnywhere, Category = Region)
+	bool bUnboundedRegion;
+
+	/** Half size of the region around actor location, used when region is bounded */
+	UPROPERTY(EditAnywhere, Category = Region)
+	FVector2D RegionExtent;
+
+	/** Region with higher priority wins where regions overlap (e.g. lagoon inside the open sea) */
+	UPROPERTY(EditAnywhere, Category = Region)
+	int32 RegionPriority;
+
+	/** How often server sends fresh time base to clients [sec] */
+	UPROPERTY(EditAnywhere, Category = OceanSetup, meta = (ClampMin = "0.1"))
+	float OceanClockSyncInterval;
+
+	/** Ocean time base, server is the only one who changes it */
+	UPROPERTY(ReplicatedUsing = OnRep_OceanClock)
+	FVaOceanClock OceanClock;
+
+	/** Server world time when actor is sent to client first, tells how old the received time base is */
+	UPROPERTY(Replicated)
+	float InitialServerTime;
+
+	/** Adjust local time base to the received one */
+	UFUNCTION()
+	void OnRep_OceanClock();
+
+	/** Start new time base from current ocean time (server only) */
+	void ResyncOceanClock();
+
+	/** Wind and amplitude set at runtime */
+	UPROPERTY(ReplicatedUsing = OnRep_SeaState)
+	FVaOceanSeaState SeaState;
+
+	/** Apply received sea state */
+	UFUNCTION()
+	void OnRep_SeaState();
+
+	/** Put sea state into spectrum config and pass it to ocean model */
+	virtual void ApplySeaState();
+
+	/** One-way network delay of local player [sec] */
+	float GetClockLatency() const;
+
 	//UPROPERTY(EditAnywhere, Category = OceanSetup)
 	//float WorldPositionDivider;
 
@@ -0,0 +1,67 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+#include "VaOceanStateActorBaked.generated.h"
+
+/**
+ * Plays looping FFT ocean animation baked offline, so there is no simulation at runtime at all
+ */
+UCLASS(ClassGroup = VaOcean, Blueprintable, BlueprintType)
+class AVaOceanStateActorBaked : public AVaOceanStateActor
+{
+	GENERATED_UCLASS_BODY()
+
+	//////////////////////////////////////////////////////////////////////////
+	// Baked ocean model API
+
+	/** Is baked animation loaded */
+	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
+	bool IsAnimationLoaded() const;
+
+	/** Simulate one loop of spectrum config and write it to animation file */
+	bool BakeAnimation();
+
+	/** Map animation file (again) */
+	bool LoadAnimation();
+
+	/** Full path of animation file */
+	FString GetAnimationFilePath() const;
+
+	// Begin AActor interface
+	virtual void PostInitializeComponents() override;
+	// End AActor interface
+
+#if WITH_EDITOR
+	// Begin UObject interface
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	// End UObject interface
+#endif // WITH_EDITOR
+
+protected:
+	/** Animation file relative to game content directory. It isn't an asset, so it should be staged as non-UFS file. */
+	UPROPERTY(EditAnywhere, Category = Baking)
+	FString AnimationFile;
+
+	/** How much frames are baked for one loop period */
+	UPROPERTY(EditAnywhere, Category = Baking, meta = (ClampMin = "2", ClampMax = "1024"))
+	int32 NumBakedFrames;
+
+	/** Grid size of baked frames. Must be power of 2. */
+	UPROPERTY(EditAnywhere, Category = Baking, meta = (ClampMin = "16", ClampMax = "512"))
+	int32 BakedDimension;
+
+#if WITH_EDITORONLY_DATA
+	/** Check to bake animation file with current spectrum config */
+	UPROPERTY(EditAnywhere, Transient, Category = Baking)
+	bool bBakeAnimation;
+#endif // WITH_EDITORONLY_DATA
+
+	/** Mapped animation shared by all snapshots */
+	TSharedPtr<FVaOceanBakedAnimation, ESPMode::ThreadSafe> Animation;
+
+	// Begin AVaOceanStateActor interface
+	virtual void BuildOceanSnapshot(FVaOceanSnapshot& OutSnapshot) const override;
+	// End AVaOceanStateActor interface
+
+};
@@ -0,0 +1,88 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+#include "VaOceanStateActorGerstner.generated.h"
+
+/**
+ * Calculates wave height, normal and orbital velocity analytically as a sum of Gerstner waves
+ */
+UCLASS(ClassGroup = VaOcean, Blueprintable, BlueprintType)
+class AVaOceanStateActorGerstner : public AVaOceanStateActor
+{
+	GENERATED_UCLASS_BODY()
+
+	// Begin AVaOceanStateActor interface
+	virtual int32 GetOceanWavesNum() const override;
+	// End AVaOceanStateActor interface
+
+	//////////////////////////////////////////////////////////////////////////
+	// Gerstner ocean model API
+
+	/** Replace wave set and rebuild evaluation cache */
+	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
+	void SetWaves(const TArray<FGerstnerWave>& InWaves);
+
+	/** Current wave set */
+	const TArray<FGerstnerWave>& GetWaves() const;
+
+	/** Generate wave set that approximates Phillips spectrum of spectrum config */
+	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
+	void GenerateWavesFromSpectrum();
+
+	// Begin AActor interface
+	virtual void PostInitializeComponents() override;
+	virtual void Tick(float DeltaSeconds) override;
+	// End AActor interface
+
+#if WITH_EDITOR
+	// Begin UObject interface
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	// End UObject interface
+#endif // WITH_EDITOR
+
+protected:
+	/** Waves to be summed */
+	UPROPERTY(EditAnywhere, Category = Gerstner)
+	TArray<FGerstnerWave> Waves;
+
+	/** Ignore manually set waves and build them from spectrum config (wind speed and direction) */
+	UPROPERTY(EditAnywhere, Category = Gerstner)
+	bool bGenerateWavesFromSpectrum;
+
+	/** How much waves should be generated from spectrum config */
+	UPROPERTY(EditAnywhere, Category = Gerstner, meta = (ClampMin = "1", ClampMax = "64"))
+	int32 NumGeneratedWaves;
+
+	/** Horizontal displacement makes wave profile shifted, this is how much steps are done to find the right point */
+	UPROPERTY(EditAnywhere, Category = Gerstner, meta = (ClampMin = "0", ClampMax = "4"))
+	int32 InverseDisplacementIterations;
+
+	/** Rebuild SIMD friendly wave data */
+	void UpdateWaveCache();
+
+	/** Mix waves of previous sea state with the current ones, by ocean time */
+	void UpdateWaveBlend();
+
+	/** Weight of current waves in cross-fade, 1 when nothing is blended */
+	float GetWaveBlendAlpha() const;
+
+	/** Wave data shared by all snapshots */
+	FVaOceanWaveSetPtr WaveSet;
+
+	/** Wave data of current waves, it is the same as WaveSet when nothing is blended */
+	FVaOceanWaveSetPtr TargetWaveSet;
+
+	/** Waves that were visible when sea state was changed, they are faded out */
+	FVaOceanWaveSetPtr BlendSourceWaveSet;
+
+	/** Cross-fade timing [ocean sec] */
+	float WaveBlendStartTime;
+	float WaveBlendTime;
+
+	// Begin AVaOceanStateActor interface
+	virtual void BuildOceanSnapshot(FVaOceanSnapshot& OutSnapshot) const override;
+	virtual void ApplySeaState() override;
+	// End AVaOceanStateActor interface
+
+};
@@ -13,9 +13,6 @@ class AVaOceanStateActorSimple : public AVaOceanStateActor
 	GENERATED_UCLASS_BODY()
 
 	// Begin AVaOceanStateActor interface
-	virtual float GetOceanLevelAtLocation(FVector& Location) const override;
-	virtual FLinearColor GetOceanSurfaceNormal(FVector& Location) const override;
-	virtual FVector GetOceanWaveVelocity(FVector& Location) const override;
 	int32 GetOceanWavesNum() const override;
 	// End AVaOceanStateActor interface
 
@@ -46,10 +43,14 @@ class AVaOceanStateActorSimple : public AVaOceanStateActor
 	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
 	float GetWaterHeight() const;
 
-	/** Set time for waves movement calculation */
+	/** Set time for waves movement calculation. Used only if panner is not driven by ocean clock. */
 	UFUNCTION(BlueprintCallable, Category = "World|VaOcean")
 	void SetWaveHeightPannerTime(float Time);
 
+	/** Move waves with replicated ocean clock, so server and clients have the same wave phase */
+	UPROPERTY(EditAnywhere, Category = OceanSetup)
+	bool bPannerUsesOceanClock;
+
 	/** Normalmap which will be used to determite the wave height */
 	UPROPERTY(EditAnywhere, Category = OceanSetup)
 	class UTexture2D* OceanHeightMap;
@@ -62,7 +63,18 @@ class AVaOceanStateActorSimple : public AVaOceanStateActor
 	virtual void PostInitializeComponents() override;
 	// End AActor interface
 
+	// Begin UObject interface
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PreSave() override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif // WITH_EDITOR
+	// End UObject interface
+
 protected:
+	// Begin AVaOceanStateActor interface
+	virtual void BuildOceanSnapshot(FVaOceanSnapshot& OutSnapshot) const override;
+	// End AVaOceanStateActor interface
 
 	//////////////////////////////////////////////////////////////////////////
 	// Cached data to prevent large memory operations each frame
@@ -70,11 +82,38 @@ protected:
 	/** Flat to keep "uncompression" state */
 	bool bRawDataReady;
 
-	/** Decompressed PNG image */
-	TArray<uint8> HeightMapRawData;
+	/** Heightmap alpha channel baked from texture source, the only channel we use for waves. Moved to heightmap grid in game. */
+	UPROPERTY()
+	TArray<uint8> HeightMapData;
+
+	/** Baked heightmap width */
+	UPROPERTY()
+	int32 HeightMapSizeX;
+
+	/** Baked heightmap height */
+	UPROPERTY()
+	int32 HeightMapSizeY;
+
+	/** Heightmap data prepared for sampling, shared by all snapshots */
+	FVaOceanGridPtr HeightMapGrid;
+
+	/** Rebuild heightmap grid, should be called each time heightmap or its scale are changed */
+	void UpdateHeightMapGrid();
+
+	/** Recalculate panner offset, should be called each time panner params are changed */
+	void UpdateSamplerParams();
+
+	/** Panner offset in texels for desired panner time */
+	void GetPannerTexels(float PannerTime, float& OutTexelsX, float& OutTexelsY) const;
+
+	/** Panner offset in texels (with half texel shift like GPU sampler) */
+	float PannerTexelsX;
+	float PannerTexelsY;
 
-	/** Return pixel color from loaded raw data */
-	FColor GetHeighMapPixelColor(float U, float V) const;
+#if WITH_EDITOR
+	/** Extract alpha channel from heightmap source art, so it's available in cooked builds */
+	void BakeHeightMap();
+#endif // WITH_EDITOR
 
 
 	//////////////////////////////////////////////////////////////////////////
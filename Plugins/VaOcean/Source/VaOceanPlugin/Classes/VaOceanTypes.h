@@ -4,6 +4,28 @@
 
 #include "VaOceanTypes.generated.h"
 
+/** One patch of multi-scale FFT ocean */
+USTRUCT()
+struct FSpectrumCascade
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The size of cascade displacement map. Must be power of 2, 64 or 128 is enough for most cascades. */
+	UPROPERTY(EditDefaultsOnly, Category = Ocean)
+	int32 DispMapDimension;
+
+	/** The side length (world space) of cascade patch. Cascades should have different lengths. */
+	UPROPERTY(EditDefaultsOnly, Category = Ocean)
+	float PatchLength;
+
+	/** Defaults */
+	FSpectrumCascade()
+	{
+		DispMapDimension = 128;
+		PatchLength = 2000.0f;
+	}
+};
+
 /** Phillips spectrum configuration */
 USTRUCT()
 struct FSpectrumData
@@ -43,6 +65,37 @@ struct FSpectrumData
 	UPROPERTY(EditDefaultsOnly, Category = Ocean)
 	float ChoppyScale;
 
+	/** How much fixed-point steps are done to find the choppy surface point above desired XY. 0 reads the height right at XY. */
+	UPROPERTY(EditDefaultsOnly, Category = Ocean, meta = (ClampMin = "0", ClampMax = "4"))
+	int32 InverseDisplacementIterations;
+
+	/** Seed of the random generator used for initial spectrum. Same seed gives the same waves on all machines. */
+	UPROPERTY(EditDefaultsOnly, Category = Ocean)
+	int32 RandomSeed;
+
+	/** Waves repeat with this period [ocean sec], frequencies are quantized for it. 0 disables looping. */
+	UPROPERTY(EditDefaultsOnly, Category = Ocean, meta = (ClampMin = "0.0"))
+	float LoopPeriod;
+
+	/**
+	 * CPU simulation cascades (up to 4). Each one gets its own band of wave numbers, so long waves come from
+	 * the largest patch and short ones from the smallest. Empty means one DispMapDimension x PatchLength patch.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = Ocean)
+	TArray<FSpectrumCascade> Cascades;
+
+	/** Grid size of the finest physics LOD for the longest cascade (band-limited copy of the same waves). 0 disables physics LODs. */
+	UPROPERTY(EditDefaultsOnly, Category = Physics, meta = (ClampMin = "0"))
+	int32 PhysicsLODDimension;
+
+	/** Number of physics LODs, each next one keeps only waves twice as long as the previous one */
+	UPROPERTY(EditDefaultsOnly, Category = Physics, meta = (ClampMin = "0"))
+	int32 NumPhysicsLODs;
+
+	/** Dedicated server simulates physics LODs only, full resolution queries get the finest LOD */
+	UPROPERTY(EditDefaultsOnly, Category = Physics)
+	bool bPhysicsOnlyOnDedicatedServer;
+
 	/** Defaults */
 	FSpectrumData()
 	{
@@ -54,5 +107,142 @@ struct FSpectrumData
 		WindSpeed = 600.0f;
 		WindDependency = 0.07f;
 		ChoppyScale = 1.3f;
+		InverseDisplacementIterations = 2;
+		RandomSeed = 0;
+		LoopPeriod = 0.0f;
+		PhysicsLODDimension = 64;
+		NumPhysicsLODs = 2;
+		bPhysicsOnlyOnDedicatedServer = false;
+	}
+};
+
+/** Single Gerstner wave component */
+USTRUCT(BlueprintType)
+struct FGerstnerWave
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Wave travel direction. Normalization not required */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Wave)
+	FVector2D Direction;
+
+	/** Distance between two crests (world space) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Wave)
+	float WaveLength;
+
+	/** Crest height above the rest level (world space) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Wave)
+	float Amplitude;
+
+	/** 0 gives sine wave, 1 gives the sharpest crest that can't produce loops when all waves are summed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Wave)
+	float Steepness;
+
+	/** Initial phase shift [rad] */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Wave)
+	float Phase;
+
+	/** Defaults */
+	FGerstnerWave()
+	{
+		Direction = FVector2D(1.0f, 0.0f);
+		WaveLength = 1000.0f;
+		Amplitude = 20.0f;
+		Steepness = 0.5f;
+		Phase = 0.0f;
+	}
+};
+
+/**
+ * Ocean time base replicated from server: OceanTime = BaseOceanTime + (ServerTime - BaseServerTime) * TimeScale.
+ * Clients estimate ServerTime as their own world time shifted by half ping (and by the base age when they join).
+ */
+USTRUCT()
+struct FVaOceanClock
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Ocean time at the moment of last sync */
+	UPROPERTY()
+	float BaseOceanTime;
+
+	/** Server world time at the moment of last sync */
+	UPROPERTY()
+	float BaseServerTime;
+
+	/** Ocean time speed relative to world time */
+	UPROPERTY()
+	float TimeScale;
+
+	/** Defaults */
+	FVaOceanClock()
+	{
+		BaseOceanTime = 0.0f;
+		BaseServerTime = 0.0f;
+		TimeScale = 1.0f;
+	}
+};
+
+/** Runtime sea state that overrides spectrum config wind and amplitude, is replicated from server */
+USTRUCT()
+struct FVaOceanSeaState
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Wind direction. Normalization not required */
+	UPROPERTY()
+	FVector2D WindDirection;
+
+	/** Wind speed, same meaning as spectrum config one */
+	UPROPERTY()
+	float WindSpeed;
+
+	/** Amplitude for transverse wave, same meaning as spectrum config one */
+	UPROPERTY()
+	float WaveAmplitude;
+
+	/** Ocean time when cross-fade to this state starts */
+	UPROPERTY()
+	float BlendStartTime;
+
+	/** Cross-fade duration [ocean sec] */
+	UPROPERTY()
+	float BlendTime;
+
+	/** How much times sea state was changed, zero means spectrum config is used as is */
+	UPROPERTY()
+	int32 Revision;
+
+	/** Defaults */
+	FVaOceanSeaState()
+	{
+		WindDirection = FVector2D::ZeroVector;
+		WindSpeed = 0.0f;
+		WaveAmplitude = 0.0f;
+		BlendStartTime = 0.0f;
+		BlendTime = 0.0f;
+		Revision = 0;
+	}
+};
+
+/** Hull mesh of buoyancy component used up to desired view distance */
+USTRUCT()
+struct FVaOceanHullLOD
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Closed low-poly hull (tens of triangles) in space of actor root component, LOD 0 of the mesh is used */
+	UPROPERTY(EditAnywhere, Category = Hull)
+	UStaticMesh* Mesh;
+
+	/** Distance to the closest viewer up to which this LOD is used, 0 means no limit [uu] */
+	UPROPERTY(EditAnywhere, Category = Hull, meta = (ClampMin = "0"))
+	float MaxDistance;
+
+	/** Defaults */
+	FVaOceanHullLOD()
+	{
+		Mesh = NULL;
+		MaxDistance = 0.0f;
 	}
 };
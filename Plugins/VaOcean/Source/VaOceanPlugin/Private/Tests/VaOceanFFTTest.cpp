@@ -0,0 +1,132 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+#if WITH_EDITOR
+
+/** Double precision complex number for reference transforms */
+struct FVaOceanTestComplex
+{
+	double Re;
+	double Im;
+
+	FVaOceanTestComplex() : Re(0.0), Im(0.0) {}
+	FVaOceanTestComplex(double InRe, double InIm) : Re(InRe), Im(InIm) {}
+};
+
+/**
+ * Naive inverse DFT with exp(+2 * pi * i * k * n / N) kernel of every line of Dim x Dim grid.
+ * Stride is distance between line elements, LineStride is distance between lines.
+ */
+static void VaOceanNaiveDFT(const TArray<FVaOceanTestComplex>& In, TArray<FVaOceanTestComplex>& Out, int32 Dim, int32 Stride, int32 LineStride)
+{
+	// Kernel depends on k * n mod Dim only
+	TArray<FVaOceanTestComplex> Kernel;
+	for (int32 i = 0; i < Dim; i++)
+	{
+		const double Angle = 2.0 * PI * i / Dim;
+		Kernel.Add(FVaOceanTestComplex(cos(Angle), sin(Angle)));
+	}
+
+	Out.Empty(In.Num());
+	Out.AddZeroed(In.Num());
+
+	for (int32 Line = 0; Line < Dim; Line++)
+	{
+		const int32 First = Line * LineStride;
+
+		for (int32 n = 0; n < Dim; n++)
+		{
+			FVaOceanTestComplex Sum;
+			for (int32 k = 0; k < Dim; k++)
+			{
+				const FVaOceanTestComplex& X = In[First + k * Stride];
+				const FVaOceanTestComplex& W = Kernel[(k * n) & (Dim - 1)];
+				Sum.Re += X.Re * W.Re - X.Im * W.Im;
+				Sum.Im += X.Re * W.Im + X.Im * W.Re;
+			}
+
+			Out[First + n * Stride] = Sum;
+		}
+	}
+}
+
+/** Max error of transformed grid relative to the largest reference value */
+static double VaOceanRelativeError(const TArray<FVector2D>& Result, const TArray<FVaOceanTestComplex>& Reference)
+{
+	double MaxError = 0.0;
+	double MaxValue = 1.0;
+
+	for (int32 i = 0; i < Reference.Num(); i++)
+	{
+		MaxError = FMath::Max(MaxError, FMath::Max(FMath::Abs(Result[i].X - Reference[i].Re), FMath::Abs(Result[i].Y - Reference[i].Im)));
+		MaxValue = FMath::Max(MaxValue, FMath::Max(FMath::Abs(Reference[i].Re), FMath::Abs(Reference[i].Im)));
+	}
+
+	return MaxError / MaxValue;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVaOceanFFTTest, "VaOcean.FFT", EAutomationTestFlags::ATF_Editor)
+
+/**
+ * Compare SIMD FFT with double precision naive DFT. Sizes that are not powers of 8 run radix-2 stages
+ * before radix-8 ones, so all sizes from 2 to 512 are checked. Rows and columns go different load/store paths.
+ */
+bool FVaOceanFFTTest::RunTest(const FString& Parameters)
+{
+	// Float FFT error grows with number of levels
+	const double TolerancePerLevel = 2e-6;
+
+	FRandomStream RandomStream(0x0CEA);
+	bool bSuccess = true;
+
+	for (int32 Dim = 2; Dim <= 512; Dim *= 2)
+	{
+		FVaOceanFFT FFT;
+		FFT.Init(Dim);
+
+		TArray<FVector2D> Input;
+		TArray<FVaOceanTestComplex> ReferenceInput;
+		for (int32 i = 0; i < Dim * Dim; i++)
+		{
+			const FVector2D Value(RandomStream.FRandRange(-1.0f, 1.0f), RandomStream.FRandRange(-1.0f, 1.0f));
+			Input.Add(Value);
+			ReferenceInput.Add(FVaOceanTestComplex(Value.X, Value.Y));
+		}
+
+		TArray<FVaOceanTestComplex> RowsReference;
+		TArray<FVaOceanTestComplex> ColumnsReference;
+		TArray<FVaOceanTestComplex> GridReference;
+		VaOceanNaiveDFT(ReferenceInput, RowsReference, Dim, 1, Dim);
+		VaOceanNaiveDFT(ReferenceInput, ColumnsReference, Dim, Dim, 1);
+		VaOceanNaiveDFT(RowsReference, GridReference, Dim, Dim, 1);
+
+		const double Tolerance = TolerancePerLevel * FMath::FloorLog2(Dim);
+
+		TArray<FVector2D> Rows = Input;
+		FVector2D* RowsPtr = Rows.GetTypedData();
+		FFT.InverseRows(&RowsPtr, 1);
+
+		TArray<FVector2D> Columns = Input;
+		FVector2D* ColumnsPtr = Columns.GetTypedData();
+		FFT.InverseColumns(&ColumnsPtr, 1);
+
+		TArray<FVector2D> Grid = Input;
+		FFT.Inverse2D(Grid);
+
+		const double RowsError = VaOceanRelativeError(Rows, RowsReference);
+		const double ColumnsError = VaOceanRelativeError(Columns, ColumnsReference);
+		const double GridError = VaOceanRelativeError(Grid, GridReference);
+
+		if (RowsError > Tolerance || ColumnsError > Tolerance || GridError > Tolerance)
+		{
+			AddError(FString::Printf(TEXT("FFT %dx%d differs from DFT: rows %g, columns %g, grid %g (tolerance %g)"),
+				Dim, Dim, RowsError, ColumnsError, GridError, Tolerance));
+			bSuccess = false;
+		}
+	}
+
+	return bSuccess;
+}
+
+#endif // WITH_EDITOR
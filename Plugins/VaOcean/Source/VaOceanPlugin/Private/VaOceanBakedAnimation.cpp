@@ -0,0 +1,280 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanBakedAnimation
+
+FVaOceanBakedAnimation::FVaOceanBakedAnimation()
+	: Header(NULL)
+	, FrameScales(NULL)
+	, Texels(NULL)
+	, TexelsPerFrame(0)
+	, TexelsPerUnitX(0.0f)
+	, TexelsPerUnitY(0.0f)
+{
+}
+
+FVaOceanBakedAnimation::~FVaOceanBakedAnimation()
+{
+	Close();
+}
+
+bool FVaOceanBakedAnimation::Open(const FString& Filename)
+{
+	Close();
+
+	if (!File.Open(Filename))
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Can't open baked ocean animation %s"), *Filename);
+		return false;
+	}
+
+	const uint8* Data = File.GetData();
+	const int64 FileSize = File.GetSize();
+
+	const FHeader* FileHeader = (const FHeader*)Data;
+	if (FileSize < (int64)sizeof(FHeader) || FileHeader->Magic != FileMagic || FileHeader->Version != FileVersion)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Baked ocean animation %s has wrong format, it should be rebaked"), *Filename);
+		Close();
+		return false;
+	}
+
+	const int64 NumTexels = (int64)FileHeader->SizeX * FileHeader->SizeY * FileHeader->NumFrames;
+	const int64 ExpectedSize = FileHeader->TexelDataOffset + NumTexels * sizeof(FVaOceanBakedTexel);
+	if (!FMath::IsPowerOfTwo(FileHeader->SizeX) || !FMath::IsPowerOfTwo(FileHeader->SizeY) || FileHeader->NumFrames < 2 ||
+		FileHeader->LoopPeriod <= KINDA_SMALL_NUMBER || FileSize < ExpectedSize)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Baked ocean animation %s is corrupted"), *Filename);
+		Close();
+		return false;
+	}
+
+	Header = FileHeader;
+	FrameScales = (const FVaOceanBakedFrameScale*)(Data + sizeof(FHeader));
+	Texels = (const FVaOceanBakedTexel*)(Data + Header->TexelDataOffset);
+
+	TexelsPerFrame = Header->SizeX * Header->SizeY;
+	TexelsPerUnitX = Header->SizeX / Header->PatchLength;
+	TexelsPerUnitY = Header->SizeY / Header->PatchLength;
+
+	UE_LOG(LogVaOcean, Log, TEXT("Baked ocean animation %s: %dx%d, %d frames, %.1f sec (%s)"),
+		*Filename, Header->SizeX, Header->SizeY, Header->NumFrames, Header->LoopPeriod, File.IsMapped() ? TEXT("mapped") : TEXT("loaded"));
+
+	return true;
+}
+
+void FVaOceanBakedAnimation::Close()
+{
+	File.Close();
+
+	Header = NULL;
+	FrameScales = NULL;
+	Texels = NULL;
+	TexelsPerFrame = 0;
+}
+
+bool FVaOceanBakedAnimation::IsValid() const
+{
+	return Header != NULL;
+}
+
+int32 FVaOceanBakedAnimation::GetNumFrames() const
+{
+	return Header ? Header->NumFrames : 0;
+}
+
+float FVaOceanBakedAnimation::GetLoopPeriod() const
+{
+	return Header ? Header->LoopPeriod : 0.0f;
+}
+
+float FVaOceanBakedAnimation::GetFrameDuration() const
+{
+	return Header ? Header->LoopPeriod / Header->NumFrames : 0.0f;
+}
+
+void FVaOceanBakedAnimation::GetFramesAtTime(float Time, int32& OutFrameA, int32& OutFrameB, float& OutAlpha) const
+{
+	check(IsValid());
+
+	// Position inside the loop, negative time wraps too
+	float LoopTime = FMath::Fmod(Time, Header->LoopPeriod);
+	if (LoopTime < 0.0f)
+	{
+		LoopTime += Header->LoopPeriod;
+	}
+
+	const float FramePosition = LoopTime / Header->LoopPeriod * Header->NumFrames;
+	OutFrameA = FMath::Clamp(FMath::FloorToInt(FramePosition), 0, Header->NumFrames - 1);
+	OutFrameB = (OutFrameA + 1) % Header->NumFrames;
+	OutAlpha = FMath::Clamp(FramePosition - OutFrameA, 0.0f, 1.0f);
+}
+
+void FVaOceanBakedAnimation::Sample(int32 FrameA, int32 FrameB, float Alpha, float X, float Y, float& OutHeight, FVector2D& OutGradient, FVector& OutVelocity) const
+{
+	check(IsValid());
+
+	const float TexelX = X * TexelsPerUnitX;
+	const float TexelY = Y * TexelsPerUnitY;
+
+	const int32 X0 = FMath::FloorToInt(TexelX);
+	const int32 Y0 = FMath::FloorToInt(TexelY);
+	const float FracX = TexelX - X0;
+	const float FracY = TexelY - Y0;
+
+	// Dimensions are power of two, so mask wraps negative coords too
+	const int32 MaskX = Header->SizeX - 1;
+	const int32 MaskY = Header->SizeY - 1;
+	const int32 PX0 = X0 & MaskX;
+	const int32 PX1 = (X0 + 1) & MaskX;
+	const int32 PY0 = (Y0 & MaskY) * Header->SizeX;
+	const int32 PY1 = ((Y0 + 1) & MaskY) * Header->SizeX;
+
+	// Bilinear fetch from both frames
+	const FVector DisplacementA = FMath::Lerp(
+		FMath::Lerp(GetDisplacement(FrameA, PY0 + PX0), GetDisplacement(FrameA, PY0 + PX1), FracX),
+		FMath::Lerp(GetDisplacement(FrameA, PY1 + PX0), GetDisplacement(FrameA, PY1 + PX1), FracX), FracY);
+	const FVector DisplacementB = FMath::Lerp(
+		FMath::Lerp(GetDisplacement(FrameB, PY0 + PX0), GetDisplacement(FrameB, PY0 + PX1), FracX),
+		FMath::Lerp(GetDisplacement(FrameB, PY1 + PX0), GetDisplacement(FrameB, PY1 + PX1), FracX), FracY);
+
+	const FVector2D GradientA = FMath::Lerp(
+		FMath::Lerp(GetGradient(FrameA, PY0 + PX0), GetGradient(FrameA, PY0 + PX1), FracX),
+		FMath::Lerp(GetGradient(FrameA, PY1 + PX0), GetGradient(FrameA, PY1 + PX1), FracX), FracY);
+	const FVector2D GradientB = FMath::Lerp(
+		FMath::Lerp(GetGradient(FrameB, PY0 + PX0), GetGradient(FrameB, PY0 + PX1), FracX),
+		FMath::Lerp(GetGradient(FrameB, PY1 + PX0), GetGradient(FrameB, PY1 + PX1), FracX), FracY);
+
+	OutHeight = FMath::Lerp(DisplacementA.Z, DisplacementB.Z, Alpha);
+	OutGradient = FMath::Lerp(GradientA, GradientB, Alpha);
+
+	// Frames are evenly spaced, so their difference gives the velocity for free
+	OutVelocity = (DisplacementB - DisplacementA) * (Header->NumFrames / Header->LoopPeriod);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Baking
+
+/** Quantize float to int16 with desired scale */
+static FORCEINLINE int16 QuantizeBakedValue(float Value, float InvScale)
+{
+	return (int16)FMath::Clamp(FMath::RoundToInt(Value * InvScale), -32767, 32767);
+}
+
+bool FVaOceanBakedAnimation::Bake(const FSpectrumData& InSpectrumConfig, int32 NumFrames, const FString& Filename)
+{
+	// File holds one tile, so cascades are baked as one big patch
+	FSpectrumData SpectrumConfig = InSpectrumConfig;
+	if (SpectrumConfig.Cascades.Num() > 0)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Baked ocean animation can't hold spectrum cascades, %dx%d patch will be baked instead"), SpectrumConfig.DispMapDimension, SpectrumConfig.DispMapDimension);
+		SpectrumConfig.Cascades.Empty();
+	}
+
+	// Nobody samples physics LODs of the baking simulator
+	SpectrumConfig.PhysicsLODDimension = 0;
+
+	if (SpectrumConfig.LoopPeriod <= KINDA_SMALL_NUMBER)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Spectrum loop period should be set to bake ocean animation"));
+		return false;
+	}
+
+	if (NumFrames < 2)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("At least two frames are required to bake ocean animation"));
+		return false;
+	}
+
+	FArchive* Writer = IFileManager::Get().CreateFileWriter(*Filename);
+	if (Writer == NULL)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Can't create baked ocean animation file %s"), *Filename);
+		return false;
+	}
+
+	// Simulator does all the work, it doesn't need to be registered in a world for that
+	UVaOceanSimulatorComponent* Simulator = ConstructObject<UVaOceanSimulatorComponent>(UVaOceanSimulatorComponent::StaticClass());
+	Simulator->InitSpectrum(SpectrumConfig);
+
+	const int32 Dim = SpectrumConfig.DispMapDimension;
+	const int32 NumTexels = Dim * Dim;
+
+	FHeader FileHeader;
+	FMemory::Memzero(&FileHeader, sizeof(FHeader));
+	FileHeader.Magic = FileMagic;
+	FileHeader.Version = FileVersion;
+	FileHeader.SizeX = Dim;
+	FileHeader.SizeY = Dim;
+	FileHeader.NumFrames = NumFrames;
+	FileHeader.LoopPeriod = SpectrumConfig.LoopPeriod;
+	FileHeader.PatchLength = SpectrumConfig.PatchLength;
+	FileHeader.TexelDataOffset = Align(sizeof(FHeader) + NumFrames * sizeof(FVaOceanBakedFrameScale), 16);
+
+	// Scales are known after each frame is simulated, so they are written in place later
+	Writer->Serialize(&FileHeader, sizeof(FHeader));
+	TArray<uint8> Padding;
+	Padding.AddZeroed(FileHeader.TexelDataOffset - sizeof(FHeader));
+	Writer->Serialize(Padding.GetTypedData(), Padding.Num());
+
+	TArray<FVaOceanBakedFrameScale> Scales;
+	Scales.AddZeroed(NumFrames);
+
+	TArray<FVaOceanBakedTexel> FrameTexels;
+	FrameTexels.AddZeroed(NumTexels);
+
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		Simulator->UpdateDisplacementMap(SpectrumConfig.LoopPeriod * Frame / NumFrames);
+
+		FVaOceanGridPtr Grid = Simulator->GetDisplacementGrid();
+		check(Grid.IsValid() && Grid->Displacements.Num() == NumTexels && Grid->Gradients.Num() == NumTexels);
+
+		// Each frame gets its own range to keep precision
+		float MaxDisplacement = KINDA_SMALL_NUMBER;
+		float MaxGradient = KINDA_SMALL_NUMBER;
+		for (int32 Index = 0; Index < NumTexels; Index++)
+		{
+			MaxDisplacement = FMath::Max(MaxDisplacement, Grid->Displacements[Index].GetAbsMax());
+			MaxGradient = FMath::Max(MaxGradient, Grid->Gradients[Index].GetAbsMax());
+		}
+
+		Scales[Frame].DisplacementScale = MaxDisplacement / 32767.0f;
+		Scales[Frame].GradientScale = MaxGradient / 32767.0f;
+
+		const float InvDisplacementScale = 1.0f / Scales[Frame].DisplacementScale;
+		const float InvGradientScale = 1.0f / Scales[Frame].GradientScale;
+		for (int32 Index = 0; Index < NumTexels; Index++)
+		{
+			const FVector& Displacement = Grid->Displacements[Index];
+			const FVector2D& Gradient = Grid->Gradients[Index];
+			FVaOceanBakedTexel& Texel = FrameTexels[Index];
+
+			Texel.Displacement[0] = QuantizeBakedValue(Displacement.X, InvDisplacementScale);
+			Texel.Displacement[1] = QuantizeBakedValue(Displacement.Y, InvDisplacementScale);
+			Texel.Displacement[2] = QuantizeBakedValue(Displacement.Z, InvDisplacementScale);
+			Texel.Gradient[0] = QuantizeBakedValue(Gradient.X, InvGradientScale);
+			Texel.Gradient[1] = QuantizeBakedValue(Gradient.Y, InvGradientScale);
+			Texel.Padding = 0;
+		}
+
+		Writer->Serialize(FrameTexels.GetTypedData(), NumTexels * sizeof(FVaOceanBakedTexel));
+	}
+
+	Writer->Seek(sizeof(FHeader));
+	Writer->Serialize(Scales.GetTypedData(), NumFrames * sizeof(FVaOceanBakedFrameScale));
+
+	const bool bSuccess = !Writer->IsError();
+	Writer->Close();
+	delete Writer;
+
+	Simulator->MarkPendingKill();
+
+	UE_LOG(LogVaOcean, Log, TEXT("Baked ocean animation %s: %dx%d, %d frames, %.1f sec, success: %d"),
+		*Filename, Dim, Dim, NumFrames, SpectrumConfig.LoopPeriod, (int)bSuccess);
+
+	return bSuccess;
+}
@@ -15,6 +15,7 @@ UVaOceanBuoyancyComponent::UVaOceanBuoyancyComponent(const class FPostConstructI
 	TensionTorqueRollFactor = 10000000.0f;
 	TensionTorquePitchFactor = 30.0f;	// Pitch is mostly controlled by tesntion dots
 	TensionDepthFactor = 100.0f;
+	WaveDragFactor = 100.0f;
 
 	AltitudeFactor = 10.0f;
 	VelocityFactor = 1.0f;
@@ -22,13 +23,49 @@ UVaOceanBuoyancyComponent::UVaOceanBuoyancyComponent(const class FPostConstructI
 	MaxAltitudeForce = 600.0f;
 	MinimumAltituteToReact = 30.0f;
 
+	MaxOceanCascades = 0;
+	HullLength = 0.0f;
+	bFullResolutionOcean = false;
+
+	bHullBuoyancy = false;
+	WaterDensity = 1025.0f;
+	bHydrostaticBuoyancy = false;
+	HydrostaticDistance = 0.0f;
+	SubmergedVolume = 0.0f;
+	CenterOfBuoyancy = FVector::ZeroVector;
+	WaterplaneArea = 0.0f;
+
 	bDebugTensionDots = false;
 	bUseMetacentricForces = false;
 
 	LongitudinalMetacenter = FVector(0.0f, 0.0f, 150.0f);
 	TransverseMetacenter = FVector(0.0, 0.0, 50.0);
 
+	SinglePointDistance = 0.0f;
+	KinematicDistance = 0.0f;
+	SinglePointFrequency = 0.2f;
+	SinglePointDampingRatio = 0.7f;
+	KinematicInterpSpeed = 2.0f;
+	bSleepAtRest = false;
+	RestSpeed = 10.0f;
+	RestAngularSpeed = 2.0f;
+	RestTime = 5.0f;
+	WakeTiltAngle = 10.0f;
+
 	UpdatedComponent = NULL;
+	bRegisteredBody = false;
+
+	BuoyancyLOD = EVaOceanBuoyancyLOD::Full;
+	DistanceLOD = EVaOceanBuoyancyLOD::Full;
+	RestTimer = 0.0f;
+	bSimulatedBeforeKinematic = false;
+	KinematicLinearVelocity = FVector::ZeroVector;
+	KinematicAngularVelocity = FVector::ZeroVector;
+	RestAltitude = 0.0f;
+	bRestAltitudeValid = false;
+
+	// Bodies are simulated by buoyancy manager all at once
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 void UVaOceanBuoyancyComponent::InitializeComponent()
@@ -56,130 +93,243 @@ void UVaOceanBuoyancyComponent::InitializeComponent()
 		UE_LOG(LogVaOceanPhysics, Warning, TEXT("Can't find updated component for bouyancy actor!"));
 	}
 
-	// Find ocean state actor on scene
-	TActorIterator< AVaOceanStateActor > ActorItr = TActorIterator< AVaOceanStateActor >(GetWorld());
-	while (ActorItr)
-	{
-		OceanStateActor = *ActorItr;
-
-		// Don't look for next actor, we need just one!
-		break;
-		//++ActorItr;
-	}
+	// Find ocean that covers the ship
+	UpdateOceanRegion();
 
 	if (OceanStateActor.IsValid())
 	{
-		UE_LOG(LogVaOceanPhysics, Log, TEXT("Ocean state successfully found by GameState"));
+		UE_LOG(LogVaOceanPhysics, Log, TEXT("Ocean state successfully found: %s"), *OceanStateActor->GetName());
 	}
 	else
 	{
 		UE_LOG(LogVaOceanPhysics, Warning, TEXT("Can't find ocean state actor! Default ocean level will be used."));
 	}
+
+	// Hull triangles are taken once, buoyancy manager picks LOD each frame
+	HullMeshes.Empty(HullLODs.Num());
+	for (int32 LODIndex = 0; LODIndex < HullLODs.Num(); LODIndex++)
+	{
+		FVaOceanHullMesh& HullMesh = *new(HullMeshes) FVaOceanHullMesh();
+		if (!HullMesh.InitFromStaticMesh(HullLODs[LODIndex].Mesh))
+		{
+			UE_LOG(LogVaOceanPhysics, Warning, TEXT("Hull LOD %d has no triangles and will be skipped"), LODIndex);
+		}
+	}
+
+	if (bHullBuoyancy && GetHullMesh(0.0f) == NULL)
+	{
+		UE_LOG(LogVaOceanPhysics, Warning, TEXT("Hull buoyancy has no valid hull mesh! Tension dots will be used."));
+	}
+
+	// Tables are baked from the most detailed hull
+	Hydrostatics.Reset();
+	if (bHydrostaticBuoyancy || (bHullBuoyancy && HydrostaticDistance > 0.0f))
+	{
+		for (int32 LODIndex = 0; LODIndex < HullMeshes.Num(); LODIndex++)
+		{
+			if (HullMeshes[LODIndex].IsValid())
+			{
+				Hydrostatics = FVaOceanHydrostatics::FindOrBake(HullLODs[LODIndex].Mesh, HullMeshes[LODIndex]);
+				break;
+			}
+		}
+
+		if (!Hydrostatics.IsValid())
+		{
+			UE_LOG(LogVaOceanPhysics, Warning, TEXT("Can't bake hydrostatic tables without valid hull mesh!"));
+		}
+	}
+
+	if (GetWorld())
+	{
+		FVaOceanBuoyancyManager::Get(GetWorld()).Register(this);
+		bRegisteredBody = true;
+	}
 }
 
-void UVaOceanBuoyancyComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+void UVaOceanBuoyancyComponent::OnUnregister()
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	SetBuoyancyLOD(EVaOceanBuoyancyLOD::Full);
 
-	if(!UpdatedComponent)
+	if (bRegisteredBody && GetWorld())
 	{
-		return;
+		FVaOceanBuoyancyManager::Get(GetWorld()).Unregister(this);
+		bRegisteredBody = false;
 	}
 
-	// React on world
-	PerformWaveReaction(DeltaTime);
+	Super::OnUnregister();
 }
 
-void UVaOceanBuoyancyComponent::PerformWaveReaction(float DeltaTime)
+void UVaOceanBuoyancyComponent::UpdateOceanRegion()
 {
-	AActor* MyOwner = GetOwner();
-
-	if (!UpdatedComponent || MyOwner == NULL)
+	if (GetWorld() == NULL || GetOwner() == NULL)
 	{
 		return;
 	}
 
-	const FVector OldLocation = MyOwner->GetActorLocation();
-	const FRotator OldRotation = MyOwner->GetActorRotation();
-	const FVector OldLinearVelocity = UpdatedComponent->GetPhysicsLinearVelocity();
-	const FVector OldAngularVelocity = UpdatedComponent->GetPhysicsAngularVelocity();
-	const FVector OldCenterOfMassWorld = OldLocation + OldRotation.RotateVector(COMOffset);
-	const FVector OwnerScale = MyOwner->GetActorScale();
+	// Lookup is skipped while ship stays inside the same region, buoyancy manager waits for the found ocean
+	OceanStateActor = FVaOceanRegistry::Get(GetWorld()).UpdateRegionHandle(OceanRegion, GetOwner()->GetActorLocation());
+}
 
-	// XYZ === Throttle, Steering, Rise == Forwards, Sidewards, Upwards
-	FVector X, Y, Z;
-	GetAxes(OldRotation, X, Y, Z);
+const FVaOceanHullMesh* UVaOceanBuoyancyComponent::GetHullMesh(float ViewDistance) const
+{
+	const FVaOceanHullMesh* Result = NULL;
 
-	// Process tension dots and get torque from wind/waves
-	for (FVector TensionDot : TensionDots)
+	// The first LOD that covers the distance, or the coarsest one
+	for (int32 LODIndex = 0; LODIndex < HullMeshes.Num(); LODIndex++)
 	{
-		// Translate point to world coordinates
-		FVector TensionDotDisplaced = OldRotation.RotateVector(TensionDot + COMOffset);
-		FVector TensionDotWorld = OldLocation + TensionDotDisplaced;
+		if (!HullMeshes[LODIndex].IsValid())
+		{
+			continue;
+		}
 
-		// Get point depth
-		float DotAltitude = GetAltitude(TensionDotWorld);
+		Result = &HullMeshes[LODIndex];
 
-		// Don't process dots above water
-		if (DotAltitude > 0)
+		const float MaxDistance = HullLODs[LODIndex].MaxDistance;
+		if (MaxDistance <= 0.0f || ViewDistance <= MaxDistance)
 		{
-			continue;
+			break;
 		}
-		
-		// Surface normal (not modified!)
-		FVector DotSurfaceNormal = GetSurfaceNormal(TensionDotWorld) * GetSurfaceWavesNum();
-		// Modify normal with real Z value and normalize it
-		DotSurfaceNormal.Z = GetOceanLevel(TensionDotWorld);
-		DotSurfaceNormal.Normalize();
+	}
+
+	return Result;
+}
 
-		// Point dynamic pressure [http://en.wikipedia.org/wiki/Dynamic_pressure]
-		// rho = 1.03f for ocean water
-		FVector WaveVelocity = GetWaveVelocity(TensionDotWorld);
-		float DotQ = 0.515f * FMath::Square(WaveVelocity.Size());
-		FVector WaveForce = FVector(0.0,0.0,1.0) * DotQ /* DotSurfaceNormal*/ * (-DotAltitude) * TensionDepthFactor;
-		
-		// We don't want Z to be affected by DotQ
-		WaveForce.Z /= DotQ;
+const FVaOceanHydrostatics* UVaOceanBuoyancyComponent::GetHydrostatics(float ViewDistance) const
+{
+	if (!Hydrostatics.IsValid())
+	{
+		return NULL;
+	}
+
+	if (bHydrostaticBuoyancy || (bHullBuoyancy && HydrostaticDistance > 0.0f && ViewDistance > HydrostaticDistance))
+	{
+		return Hydrostatics.Get();
+	}
 
-		// Scale to DeltaTime to break FPS addiction
-		WaveForce *= DeltaTime;
+	return NULL;
+}
+
+void UVaOceanBuoyancyComponent::WakeBuoyancy()
+{
+	RestTimer = 0.0f;
+}
+
+EVaOceanBuoyancyLOD::Type UVaOceanBuoyancyComponent::UpdateBuoyancyLOD(float ViewDistance, float DeltaTime)
+{
+	// Current tier is kept a bit longer, so ship on the boundary doesn't switch each frame
+	const float Hysteresis = 0.1f;
 
-		// Apply actor scale
-		WaveForce *= OwnerScale.X;// *OwnerScale.Y * OwnerScale.Z;
+	const float SinglePointThreshold = SinglePointDistance * ((DistanceLOD >= EVaOceanBuoyancyLOD::SinglePoint) ? 1.0f - Hysteresis : 1.0f + Hysteresis);
+	const float KinematicThreshold = KinematicDistance * ((DistanceLOD == EVaOceanBuoyancyLOD::Kinematic) ? 1.0f - Hysteresis : 1.0f + Hysteresis);
 
-		UpdatedComponent->AddForceAtLocation(WaveForce * Mass, TensionDotWorld);
+	DistanceLOD = EVaOceanBuoyancyLOD::Full;
+	if (SinglePointDistance > 0.0f && ViewDistance > SinglePointThreshold)
+	{
+		DistanceLOD = EVaOceanBuoyancyLOD::SinglePoint;
+	}
+	if (KinematicDistance > 0.0f && ViewDistance > KinematicThreshold)
+	{
+		DistanceLOD = EVaOceanBuoyancyLOD::Kinematic;
 	}
 
-	// Static metacentric forces (can be useful on small waves)
-	if (bUseMetacentricForces)
+	// Player controls ship by physics, so it never sleeps
+	APawn* OwnerPawn = Cast<APawn>(GetOwner());
+	const bool bCanSleep = bSleepAtRest && UpdatedComponent && !(OwnerPawn && OwnerPawn->IsPlayerControlled());
+
+	if (!bCanSleep)
 	{
-		FVector TensionTorqueResult = FVector(0.0f, 0.0f, 0.0f);
+		RestTimer = 0.0f;
+	}
+	else if (BuoyancyLOD != EVaOceanBuoyancyLOD::Kinematic)
+	{
+		// Sleeping ship keeps its timer until something wakes it
+		const bool bResting = UpdatedComponent->GetPhysicsLinearVelocity().Size() < RestSpeed &&
+			UpdatedComponent->GetPhysicsAngularVelocity().Size() < RestAngularSpeed;
+		RestTimer = bResting ? RestTimer + DeltaTime : 0.0f;
+	}
 
-		// Calc recovering torque (transverce)
-		FRotator RollRot = FRotator(0.0f, 0.0f, 0.0f);
-		RollRot.Roll = OldRotation.Roll;
-		FVector MetacenterDisplaced = RollRot.RotateVector(TransverseMetacenter + COMOffset);
-		TensionTorqueResult += X * FVector::DotProduct((TransverseMetacenter - MetacenterDisplaced), 
-			FVector(0.0f, -1.0f, 0.0f)) * TensionTorqueRollFactor;
+	const bool bSleeping = bCanSleep && RestTimer >= RestTime;
+	SetBuoyancyLOD(bSleeping ? EVaOceanBuoyancyLOD::Kinematic : DistanceLOD, bSleeping);
 
-		// Calc recovering torque (longitude)
-		FRotator PitchRot = FRotator(0.0f, 0.0f, 0.0f);
-		PitchRot.Pitch = OldRotation.Pitch;
-		MetacenterDisplaced = PitchRot.RotateVector(LongitudinalMetacenter + COMOffset);
-		TensionTorqueResult += Y * FVector::DotProduct((LongitudinalMetacenter - MetacenterDisplaced), 
-			FVector(1.0f, 0.0f, 0.0f)) * TensionTorquePitchFactor;
+	return BuoyancyLOD;
+}
+
+void UVaOceanBuoyancyComponent::SetBuoyancyLOD(EVaOceanBuoyancyLOD::Type NewLOD, bool bSleeping)
+{
+	if (NewLOD == BuoyancyLOD)
+	{
+		return;
+	}
 
-		// Apply torque
-		TensionTorqueResult *= DeltaTime;
-		TensionTorqueResult *= OwnerScale.X;// *OwnerScale.Y * OwnerScale.Z;
-		UpdatedComponent->AddTorque(TensionTorqueResult);
+	// Kinematic ship is moved by buoyancy manager with course and speed it had, physics takes them over again
+	if (UpdatedComponent)
+	{
+		if (NewLOD == EVaOceanBuoyancyLOD::Kinematic)
+		{
+			bSimulatedBeforeKinematic = UpdatedComponent->IsSimulatingPhysics();
+
+			KinematicLinearVelocity = FVector::ZeroVector;
+			KinematicAngularVelocity = FVector::ZeroVector;
+			if (bSimulatedBeforeKinematic && !bSleeping)
+			{
+				// Heave, pitch and roll are driven by the surface
+				const FVector LinearVelocity = UpdatedComponent->GetPhysicsLinearVelocity();
+				KinematicLinearVelocity = FVector(LinearVelocity.X, LinearVelocity.Y, 0.0f);
+				KinematicAngularVelocity = FVector(0.0f, 0.0f, UpdatedComponent->GetPhysicsAngularVelocity().Z);
+			}
+
+			UpdatedComponent->SetSimulatePhysics(false);
+		}
+		else if (BuoyancyLOD == EVaOceanBuoyancyLOD::Kinematic && bSimulatedBeforeKinematic)
+		{
+			UpdatedComponent->SetSimulatePhysics(true);
+			UpdatedComponent->SetPhysicsLinearVelocity(KinematicLinearVelocity);
+			UpdatedComponent->SetPhysicsAngularVelocity(KinematicAngularVelocity);
+		}
 	}
+
+	BuoyancyLOD = NewLOD;
 }
 
-void UVaOceanBuoyancyComponent::GetAxes(FRotator A, FVector& X, FVector& Y, FVector& Z)
+void UVaOceanBuoyancyComponent::UpdateRestAltitude(float Altitude, float DeltaTime)
 {
-	FRotationMatrix R(A);
-	R.GetScaledAxes(X, Y, Z);
+	RestAltitude = bRestAltitudeValid ? FMath::FInterpTo(RestAltitude, Altitude, DeltaTime, 0.5f) : Altitude;
+	bRestAltitudeValid = true;
+}
+
+void UVaOceanBuoyancyComponent::ApplyMetacentricForces(float DeltaTime, const FVector& X, const FVector& Y)
+{
+	AActor* MyOwner = GetOwner();
+
+	if (!UpdatedComponent || MyOwner == NULL)
+	{
+		return;
+	}
+
+	const FRotator OldRotation = MyOwner->GetActorRotation();
+	const FVector OwnerScale = MyOwner->GetActorScale();
+
+	FVector TensionTorqueResult = FVector(0.0f, 0.0f, 0.0f);
+
+	// Calc recovering torque (transverce)
+	FRotator RollRot = FRotator(0.0f, 0.0f, 0.0f);
+	RollRot.Roll = OldRotation.Roll;
+	FVector MetacenterDisplaced = RollRot.RotateVector(TransverseMetacenter + COMOffset);
+	TensionTorqueResult += X * FVector::DotProduct((TransverseMetacenter - MetacenterDisplaced), 
+		FVector(0.0f, -1.0f, 0.0f)) * TensionTorqueRollFactor;
+
+	// Calc recovering torque (longitude)
+	FRotator PitchRot = FRotator(0.0f, 0.0f, 0.0f);
+	PitchRot.Pitch = OldRotation.Pitch;
+	MetacenterDisplaced = PitchRot.RotateVector(LongitudinalMetacenter + COMOffset);
+	TensionTorqueResult += Y * FVector::DotProduct((LongitudinalMetacenter - MetacenterDisplaced), 
+		FVector(1.0f, 0.0f, 0.0f)) * TensionTorquePitchFactor;
+
+	// Apply torque
+	TensionTorqueResult *= DeltaTime;
+	TensionTorqueResult *= OwnerScale.X;// *OwnerScale.Y * OwnerScale.Z;
+	UpdatedComponent->AddTorque(TensionTorqueResult);
 }
 
 FVector UVaOceanBuoyancyComponent::GetCOMOffset()
@@ -202,7 +352,7 @@ float UVaOceanBuoyancyComponent::GetAltitude(FVector& WorldLocation) const
 	return WorldLocation.Z - GetOceanLevel(WorldLocation) /*+ COMOffset.Z*/;
 }
 
-FLinearColor UVaOceanBuoyancyComponent::GetSurfaceNormal(FVector& WorldLocation) const
+FVector UVaOceanBuoyancyComponent::GetSurfaceNormal(FVector& WorldLocation) const
 {
 	if (OceanStateActor.IsValid())
 	{
@@ -212,22 +362,54 @@ FLinearColor UVaOceanBuoyancyComponent::GetSurfaceNormal(FVector& WorldLocation)
 	return FVector::UpVector;
 }
 
-int32 UVaOceanBuoyancyComponent::GetSurfaceWavesNum() const
+FVector UVaOceanBuoyancyComponent::GetWaveVelocity(FVector& WorldLocation) const
 {
 	if (OceanStateActor.IsValid())
 	{
-		return OceanStateActor->GetOceanWavesNum();
+		return OceanStateActor->GetOceanWaveVelocity(WorldLocation);
 	}
 
-	return 1;
+	return FVector::ZeroVector;
 }
 
-FVector UVaOceanBuoyancyComponent::GetWaveVelocity(FVector& WorldLocation) const
+float UVaOceanBuoyancyComponent::GetHullLength() const
+{
+	if (HullLength > 0.0f)
+	{
+		return HullLength;
+	}
+
+	// Bounds are axis aligned, so the smaller horizontal side is the safe guess for rotated hull
+	if (UpdatedComponent)
+	{
+		const FVector& Extent = UpdatedComponent->Bounds.BoxExtent;
+		return 2.0f * FMath::Min(Extent.X, Extent.Y);
+	}
+
+	return 0.0f;
+}
+
+void UVaOceanBuoyancyComponent::GetOceanStateBatch(const TArray<FVector>& WorldLocations, TArray<float>& OutLevels, TArray<FVector>& OutNormals, TArray<FVector>& OutVelocities) const
 {
 	if (OceanStateActor.IsValid())
 	{
-		return OceanStateActor->GetOceanWaveVelocity(WorldLocation);
+		// Snapshot is sampled directly, so the same data can be used off the game thread
+		FVaOceanSnapshotPtr Snapshot = OceanStateActor->GetOceanSnapshot();
+		if (Snapshot.IsValid())
+		{
+			const int32 PhysicsLOD = bFullResolutionOcean ? INDEX_NONE : Snapshot->FindPhysicsLOD(GetHullLength());
+			Snapshot->SampleBatch(WorldLocations, OutLevels, OutNormals, OutVelocities, (MaxOceanCascades > 0) ? MaxOceanCascades : MAX_int32, PhysicsLOD);
+		}
+		else
+		{
+			OceanStateActor->GetOceanStateBatch(WorldLocations, OutLevels, OutNormals, OutVelocities);
+		}
+
+		return;
 	}
 
-	return FVector::UpVector;
+	const int32 NumLocations = WorldLocations.Num();
+	OutLevels.Init(OceanLevel, NumLocations);
+	OutNormals.Init(FVector::UpVector, NumLocations);
+	OutVelocities.Init(FVector::ZeroVector, NumLocations);
 }
@@ -0,0 +1,592 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+/** Managers of all worlds, stale ones are removed on access */
+static TMap<TWeakObjectPtr<UWorld>, TSharedPtr<FVaOceanBuoyancyManager> > GVaOceanBuoyancyManagers;
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanBuoyancyTickFunction
+
+FVaOceanBuoyancyTickFunction::FVaOceanBuoyancyTickFunction()
+	: Manager(NULL)
+{
+	bCanEverTick = true;
+	TickGroup = TG_PrePhysics;
+}
+
+void FVaOceanBuoyancyTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Manager->Tick(DeltaTime);
+	}
+}
+
+FString FVaOceanBuoyancyTickFunction::DiagnosticMessage()
+{
+	return TEXT("FVaOceanBuoyancyTickFunction");
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanBuoyancyManager
+
+FVaOceanBuoyancyManager::FVaOceanBuoyancyManager(UWorld* InWorld)
+	: World(InWorld)
+	, FrameDeltaTime(0.0f)
+	, FrameGravity(0.0f)
+{
+	TickFunction.Manager = this;
+	OriginDots.Add(FVector::ZeroVector);
+}
+
+FVaOceanBuoyancyManager::~FVaOceanBuoyancyManager()
+{
+	TickFunction.UnRegisterTickFunction();
+}
+
+FVaOceanBuoyancyManager& FVaOceanBuoyancyManager::Get(UWorld* World)
+{
+	check(IsInGameThread());
+
+	TSharedPtr<FVaOceanBuoyancyManager>* Manager = GVaOceanBuoyancyManagers.Find(World);
+	if (Manager)
+	{
+		return **Manager;
+	}
+
+	// New world is a good moment to forget the destroyed ones
+	for (auto It = GVaOceanBuoyancyManagers.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TSharedPtr<FVaOceanBuoyancyManager> NewManager = MakeShareable(new FVaOceanBuoyancyManager(World));
+	GVaOceanBuoyancyManagers.Add(World, NewManager);
+
+	return *NewManager;
+}
+
+void FVaOceanBuoyancyManager::Register(UVaOceanBuoyancyComponent* Body)
+{
+	check(Body);
+
+	Bodies.AddUnique(Body);
+
+	if (!TickFunction.IsTickFunctionRegistered() && World.IsValid() && World->PersistentLevel)
+	{
+		TickFunction.RegisterTickFunction(World->PersistentLevel);
+	}
+}
+
+void FVaOceanBuoyancyManager::Unregister(UVaOceanBuoyancyComponent* Body)
+{
+	Bodies.RemoveSingleSwap(Body);
+}
+
+int32 FVaOceanBuoyancyManager::GetNumBodies() const
+{
+	return Bodies.Num();
+}
+
+void FVaOceanBuoyancyManager::AddOceanPrerequisite(AVaOceanStateActor* OceanStateActor)
+{
+	if (OceanStateActor == NULL || PrerequisiteOceans.Contains(OceanStateActor))
+	{
+		return;
+	}
+
+	// Bodies sample the snapshot published this frame. Destroyed oceans are skipped by tick manager.
+	PrerequisiteOceans.Add(OceanStateActor);
+	TickFunction.AddPrerequisite(OceanStateActor, OceanStateActor->PrimaryActorTick);
+}
+
+void FVaOceanBuoyancyManager::Tick(float DeltaTime)
+{
+	GatherBodies(DeltaTime);
+
+	if (BodyStates.Num() == 0)
+	{
+		return;
+	}
+
+	// Evaluation reads only snapshots and gathered transforms, so it's spread over workers
+	struct FEvaluateBody
+	{
+		FVaOceanBuoyancyManager* Manager;
+
+		void operator()(int32 BodyIndex) const
+		{
+			Manager->EvaluateBody(BodyIndex);
+		}
+	};
+
+	FEvaluateBody EvaluateBodyFunctor = { this };
+	VaOceanParallelFor(BodyStates.Num(), EvaluateBodyFunctor, MinBodiesPerTask);
+
+	ApplyForces(DeltaTime);
+}
+
+void FVaOceanBuoyancyManager::GatherBodies(float DeltaTime)
+{
+	BodyStates.Reset();
+	DotLocalX.Reset();
+	DotLocalY.Reset();
+	DotLocalZ.Reset();
+	HullScratch.Reset();
+
+	if (!World.IsValid())
+	{
+		return;
+	}
+
+	// Hull LODs are picked by the closest viewer, server takes all players into account
+	ViewLocations.Reset();
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = *It;
+		if (PlayerController)
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+
+	FrameDeltaTime = DeltaTime;
+	FrameGravity = -World->GetGravityZ();
+
+	for (int32 BodyIndex = 0; BodyIndex < Bodies.Num(); BodyIndex++)
+	{
+		UVaOceanBuoyancyComponent* Body = Bodies[BodyIndex].Get();
+		if (Body == NULL)
+		{
+			Bodies.RemoveAtSwap(BodyIndex--);
+			continue;
+		}
+
+		AActor* Owner = Body->GetOwner();
+		if (Body->UpdatedComponent == NULL || Owner == NULL || Owner->GetRootComponent() == NULL)
+		{
+			continue;
+		}
+
+		// Forces are applied to the root body only
+		FBodyInstance* BodyInstance = Body->UpdatedComponent->GetBodyInstance();
+		if (BodyInstance == NULL || !BodyInstance->IsValidBodyInstance())
+		{
+			continue;
+		}
+
+		// Ship could sail into another ocean region
+		Body->UpdateOceanRegion();
+		AddOceanPrerequisite(Body->OceanStateActor.Get());
+
+		FBodyState& State = *new(BodyStates) FBodyState();
+		State.Body = Body;
+		State.DefaultOceanLevel = Body->OceanLevel;
+		State.MaxCascades = (Body->MaxOceanCascades > 0) ? Body->MaxOceanCascades : MAX_int32;
+		State.PhysicsLOD = INDEX_NONE;
+
+		// Snapshot is sampled directly, so the same data can be used off the game thread
+		if (Body->OceanStateActor.IsValid())
+		{
+			State.Snapshot = Body->OceanStateActor->GetOceanSnapshot();
+			if (State.Snapshot.IsValid() && !Body->bFullResolutionOcean)
+			{
+				State.PhysicsLOD = State.Snapshot->FindPhysicsLOD(Body->GetHullLength());
+			}
+		}
+
+		// Quaternion axes are the same as rotator ones, without trigonometry
+		const FTransform& Transform = Owner->GetRootComponent()->ComponentToWorld;
+		const FQuat Rotation = Transform.GetRotation();
+		State.Location = Transform.GetLocation();
+		State.AxisX = Rotation.RotateVector(FVector(1.0f, 0.0f, 0.0f));
+		State.AxisY = Rotation.RotateVector(FVector(0.0f, 1.0f, 0.0f));
+		State.AxisZ = Rotation.RotateVector(FVector(0.0f, 0.0f, 1.0f));
+
+		// Scale to DeltaTime to break FPS addiction, actor scale is applied as well
+		State.ForceScale = DeltaTime * Transform.GetScale3D().X * Body->Mass;
+
+		// Force at location is the same force and its torque around center of mass
+		State.CenterOfMass = BodyInstance->GetCOMPosition();
+		State.Force = FVector::ZeroVector;
+		State.Torque = FVector::ZeroVector;
+		State.SubmergedVolume = 0.0f;
+		State.CenterOfBuoyancy = State.CenterOfMass;
+		State.WaterplaneArea = 0.0f;
+		State.Scale = Transform.GetScale3D().X;
+
+		// Distant and resting ships take less work
+		const float ViewDistance = GetViewDistance(State.Location);
+		State.LOD = Body->UpdateBuoyancyLOD(ViewDistance, DeltaTime);
+		State.Rotation = Rotation;
+		const bool bKinematic = (State.LOD == EVaOceanBuoyancyLOD::Kinematic);
+		State.LinearVelocity = bKinematic ? Body->KinematicLinearVelocity : Body->UpdatedComponent->GetPhysicsLinearVelocity();
+		State.AngularVelocity = FMath::DegreesToRadians(bKinematic ? Body->KinematicAngularVelocity : Body->UpdatedComponent->GetPhysicsAngularVelocity());
+		State.RestAltitude = Body->RestAltitude;
+		State.bRestAltitudeValid = Body->bRestAltitudeValid;
+		State.MeanOceanLevel = State.DefaultOceanLevel;
+		State.DeltaLinearVelocity = FVector::ZeroVector;
+		State.DeltaAngularVelocity = FVector::ZeroVector;
+		State.KinematicLocation = State.Location;
+		State.KinematicRotation = Rotation;
+		State.bDisturbed = false;
+
+		// Far bodies (and ones that asked for it) use hydrostatic tables, near hulls are clipped by ocean
+		const bool bFullLOD = (State.LOD == EVaOceanBuoyancyLOD::Full);
+		State.Hydrostatics = bFullLOD ? Body->GetHydrostatics(ViewDistance) : NULL;
+		State.Hull = (bFullLOD && State.Hydrostatics == NULL && Body->bHullBuoyancy) ? Body->GetHullMesh(ViewDistance) : NULL;
+
+		// Pressure of water column is in kg/(uu^2 * s^2), density is converted from kg/m^3 to kg/uu^3
+		State.WaterPressure = Body->WaterDensity * 1e-6f * FrameGravity;
+		State.FirstScratch = HullScratch.Num();
+
+		if (State.Hull)
+		{
+			HullScratch.AddUninitialized(State.Hull->GetScratchSize());
+		}
+
+		// Hull space dots are scaled with the mesh, coarse LODs sample the ocean at hull origin only
+		const TArray<FVector>& BodyDots = !bFullLOD ? OriginDots :
+			(State.Hydrostatics ? State.Hydrostatics->GetWaterPlanePoints() : (State.Hull ? State.Hull->GetVertices() : Body->TensionDots));
+		const bool bHullSpaceDots = (!bFullLOD || State.Hydrostatics != NULL || State.Hull != NULL);
+		const FVector DotScale = bHullSpaceDots ? Transform.GetScale3D() : FVector(1.0f);
+		const FVector DotOffset = bHullSpaceDots ? FVector::ZeroVector : Body->COMOffset;
+
+		// Dots are padded with the last one, so each body is transformed by whole SIMD registers
+		State.FirstDot = DotLocalX.Num();
+		State.NumDots = BodyDots.Num();
+		State.NumPaddedDots = (State.NumDots + VAOCEAN_SIMD_WIDTH - 1) / VAOCEAN_SIMD_WIDTH * VAOCEAN_SIMD_WIDTH;
+
+		for (int32 DotIndex = 0; DotIndex < State.NumPaddedDots; DotIndex++)
+		{
+			const FVector LocalDot = BodyDots[FMath::Min(DotIndex, State.NumDots - 1)] * DotScale + DotOffset;
+			DotLocalX.Add(LocalDot.X);
+			DotLocalY.Add(LocalDot.Y);
+			DotLocalZ.Add(LocalDot.Z);
+		}
+	}
+
+	// Workers write to their own ranges of these buffers
+	const int32 NumDots = DotLocalX.Num();
+	DotWorld.Reset();
+	DotWorld.AddUninitialized(NumDots);
+	DotOceanLevel.Reset();
+	DotOceanLevel.AddUninitialized(NumDots);
+	DotSurfaceNormal.Reset();
+	DotSurfaceNormal.AddUninitialized(NumDots);
+	DotWaveVelocity.Reset();
+	DotWaveVelocity.AddUninitialized(NumDots);
+}
+
+void FVaOceanBuoyancyManager::EvaluateBody(int32 BodyIndex)
+{
+	FBodyState& State = BodyStates[BodyIndex];
+	if (State.NumDots == 0)
+	{
+		return;
+	}
+
+	//
+	// Body space dots -> world space dots
+	//
+
+	const VectorRegister LocationX = VectorSetFloat1(State.Location.X);
+	const VectorRegister LocationY = VectorSetFloat1(State.Location.Y);
+	const VectorRegister LocationZ = VectorSetFloat1(State.Location.Z);
+	const VectorRegister AxisXX = VectorSetFloat1(State.AxisX.X);
+	const VectorRegister AxisXY = VectorSetFloat1(State.AxisX.Y);
+	const VectorRegister AxisXZ = VectorSetFloat1(State.AxisX.Z);
+	const VectorRegister AxisYX = VectorSetFloat1(State.AxisY.X);
+	const VectorRegister AxisYY = VectorSetFloat1(State.AxisY.Y);
+	const VectorRegister AxisYZ = VectorSetFloat1(State.AxisY.Z);
+	const VectorRegister AxisZX = VectorSetFloat1(State.AxisZ.X);
+	const VectorRegister AxisZY = VectorSetFloat1(State.AxisZ.Y);
+	const VectorRegister AxisZZ = VectorSetFloat1(State.AxisZ.Z);
+
+	const int32 FirstDot = State.FirstDot;
+	const int32 LastDot = State.FirstDot + State.NumDots;
+	for (int32 DotIndex = FirstDot; DotIndex < FirstDot + State.NumPaddedDots; DotIndex += VAOCEAN_SIMD_WIDTH)
+	{
+		const VectorRegister LocalX = VectorLoad(&DotLocalX[DotIndex]);
+		const VectorRegister LocalY = VectorLoad(&DotLocalY[DotIndex]);
+		const VectorRegister LocalZ = VectorLoad(&DotLocalZ[DotIndex]);
+
+		// World = Location + X * AxisX + Y * AxisY + Z * AxisZ
+		const VectorRegister WorldX = VectorMultiplyAdd(LocalX, AxisXX, VectorMultiplyAdd(LocalY, AxisYX, VectorMultiplyAdd(LocalZ, AxisZX, LocationX)));
+		const VectorRegister WorldY = VectorMultiplyAdd(LocalX, AxisXY, VectorMultiplyAdd(LocalY, AxisYY, VectorMultiplyAdd(LocalZ, AxisZY, LocationY)));
+		const VectorRegister WorldZ = VectorMultiplyAdd(LocalX, AxisXZ, VectorMultiplyAdd(LocalY, AxisYZ, VectorMultiplyAdd(LocalZ, AxisZZ, LocationZ)));
+
+		float X[VAOCEAN_SIMD_WIDTH], Y[VAOCEAN_SIMD_WIDTH], Z[VAOCEAN_SIMD_WIDTH];
+		VectorStore(WorldX, X);
+		VectorStore(WorldY, Y);
+		VectorStore(WorldZ, Z);
+
+		for (int32 Lane = 0; Lane < VAOCEAN_SIMD_WIDTH; Lane++)
+		{
+			DotWorld[DotIndex + Lane] = FVector(X[Lane], Y[Lane], Z[Lane]);
+		}
+	}
+
+	//
+	// Ocean state at dots
+	//
+
+	if (State.Snapshot.IsValid())
+	{
+		State.Snapshot->SampleBatch(&DotWorld[FirstDot], State.NumDots, &DotOceanLevel[FirstDot], &DotSurfaceNormal[FirstDot], &DotWaveVelocity[FirstDot], State.MaxCascades, State.PhysicsLOD);
+	}
+	else
+	{
+		for (int32 DotIndex = FirstDot; DotIndex < LastDot; DotIndex++)
+		{
+			DotOceanLevel[DotIndex] = State.DefaultOceanLevel;
+			DotSurfaceNormal[DotIndex] = FVector::UpVector;
+			DotWaveVelocity[DotIndex] = FVector::ZeroVector;
+		}
+	}
+
+	// Mean ocean level under the hull keeps ship altitude when LOD changes
+	float OceanLevelSum = 0.0f;
+	for (int32 DotIndex = FirstDot; DotIndex < LastDot; DotIndex++)
+	{
+		OceanLevelSum += DotOceanLevel[DotIndex];
+	}
+	State.MeanOceanLevel = OceanLevelSum / State.NumDots;
+
+	const float RestAltitude = State.bRestAltitudeValid ? State.RestAltitude : (State.Location.Z - State.MeanOceanLevel);
+
+	//
+	// Single point model
+	//
+
+	if (State.LOD == EVaOceanBuoyancyLOD::SinglePoint)
+	{
+		const UVaOceanBuoyancyComponent* Body = State.Body;
+		const FVector& Normal = DotSurfaceNormal[FirstDot];
+		const float Omega = 2.0f * PI * Body->SinglePointFrequency;
+		const float Damping = 2.0f * Body->SinglePointDampingRatio * Omega;
+
+		// Spring replaces buoyancy as a whole, so it holds the weight too
+		const float HeaveError = State.MeanOceanLevel + RestAltitude - State.Location.Z;
+		State.DeltaLinearVelocity = FVector(0.0f, 0.0f, (FMath::Square(Omega) * HeaveError - Damping * State.LinearVelocity.Z + FrameGravity) * FrameDeltaTime);
+
+		// Pitch and roll bring hull up axis to surface normal, yaw is left to ship controls
+		const FVector TiltError = State.AxisZ ^ Normal;
+		const FVector TiltVelocity = State.AngularVelocity - Normal * (State.AngularVelocity | Normal);
+		State.DeltaAngularVelocity = FMath::RadiansToDegrees(TiltError * FMath::Square(Omega) - TiltVelocity * Damping) * FrameDeltaTime;
+		return;
+	}
+
+	//
+	// Kinematic model
+	//
+
+	if (State.LOD == EVaOceanBuoyancyLOD::Kinematic)
+	{
+		const UVaOceanBuoyancyComponent* Body = State.Body;
+		const FVector& Normal = DotSurfaceNormal[FirstDot];
+		const float Alpha = FMath::Clamp(FrameDeltaTime * Body->KinematicInterpSpeed, 0.0f, 1.0f);
+
+		// Ship keeps its course and speed, up axis follows the surface
+		const FQuat Turn(FVector(0.0f, 0.0f, 1.0f), State.AngularVelocity.Z * FrameDeltaTime);
+		const FQuat Rotation = Turn * State.Rotation;
+		const FQuat TargetRotation(FRotationMatrix::MakeFromZX(Normal, Turn.RotateVector(State.AxisX)));
+
+		State.KinematicLocation = FVector(
+			State.Location.X + State.LinearVelocity.X * FrameDeltaTime,
+			State.Location.Y + State.LinearVelocity.Y * FrameDeltaTime,
+			FMath::Lerp(State.Location.Z, State.MeanOceanLevel + RestAltitude, Alpha));
+		State.KinematicRotation = FQuat::Slerp(Rotation, TargetRotation, Alpha);
+
+		// Steep waves are too rough to ride without physics
+		State.bDisturbed = (Normal.Z < FMath::Cos(FMath::DegreesToRadians(Body->WakeTiltAngle)));
+		return;
+	}
+
+	//
+	// Hydrostatic forces
+	//
+
+	if (State.Hydrostatics)
+	{
+		// Mean water plane Z = A + B * X + C * Y is fitted to ocean levels by least squares, coordinates are relative to body location
+		double Sx = 0.0, Sy = 0.0, Sz = 0.0, Sxx = 0.0, Sxy = 0.0, Syy = 0.0, Sxz = 0.0, Syz = 0.0;
+		for (int32 DotIndex = FirstDot; DotIndex < LastDot; DotIndex++)
+		{
+			const double X = DotWorld[DotIndex].X - State.Location.X;
+			const double Y = DotWorld[DotIndex].Y - State.Location.Y;
+			const double Z = DotOceanLevel[DotIndex] - State.Location.Z;
+
+			Sx += X;
+			Sy += Y;
+			Sz += Z;
+			Sxx += X * X;
+			Sxy += X * Y;
+			Syy += Y * Y;
+			Sxz += X * Z;
+			Syz += Y * Z;
+		}
+
+		const double N = State.NumDots;
+		const double Det = N * (Sxx * Syy - Sxy * Sxy) - Sx * (Sx * Syy - Sxy * Sy) + Sy * (Sx * Sxy - Sxx * Sy);
+
+		// Points on one line give level only
+		double A = Sz / N, B = 0.0, C = 0.0;
+		if (FMath::Abs(Det) > SMALL_NUMBER)
+		{
+			A = (Sz * (Sxx * Syy - Sxy * Sxy) - Sx * (Sxz * Syy - Sxy * Syz) + Sy * (Sxz * Sxy - Sxx * Syz)) / Det;
+			B = (N * (Sxz * Syy - Sxy * Syz) - Sz * (Sx * Syy - Sxy * Sy) + Sy * (Sx * Syz - Sxz * Sy)) / Det;
+			C = (N * (Sxx * Syz - Sxz * Sxy) - Sx * (Sx * Syz - Sxz * Sy) + Sz * (Sx * Sxy - Sxx * Sy)) / Det;
+		}
+
+		// Water plane in hull space: heel and trim are its slopes along hull axes, draft is its height at hull origin
+		const FVector WorldNormal = FVector((float)-B, (float)-C, 1.0f).SafeNormal();
+		const FVector HullNormal(WorldNormal | State.AxisX, WorldNormal | State.AxisY, WorldNormal | State.AxisZ);
+		const FVector HullPoint = FVector(State.AxisX.Z, State.AxisY.Z, State.AxisZ.Z) * ((float)A / State.Scale);
+
+		const float Heel = FMath::Atan2(-HullNormal.Y, HullNormal.Z);
+		const float Trim = FMath::Atan2(-HullNormal.X, HullNormal.Z);
+		const float Draft = (HullNormal | HullPoint) / FMath::Max(HullNormal.Z, KINDA_SMALL_NUMBER);
+
+		const FVaOceanHydrostaticSample Sample = State.Hydrostatics->Lookup(Draft, Heel, Trim);
+		const FVector& CenterOfBuoyancy = Sample.CenterOfBuoyancy;
+
+		State.SubmergedVolume = Sample.Volume * FMath::Pow(State.Scale, 3.0f);
+		State.WaterplaneArea = Sample.WaterplaneArea * FMath::Square(State.Scale);
+		State.CenterOfBuoyancy = State.Location + (State.AxisX * CenterOfBuoyancy.X + State.AxisY * CenterOfBuoyancy.Y + State.AxisZ * CenterOfBuoyancy.Z) * State.Scale;
+
+		// Buoyancy pushes along the normal of mean water plane, righting moment comes from shift of the centre of buoyancy
+		State.Force = WorldNormal * (State.WaterPressure * State.SubmergedVolume);
+		State.Torque = (State.CenterOfBuoyancy - State.CenterOfMass) ^ State.Force;
+		return;
+	}
+
+	//
+	// Hull forces
+	//
+
+	if (State.Hull)
+	{
+		// Ocean level turns into vertex depth below the surface
+		for (int32 DotIndex = FirstDot; DotIndex < LastDot; DotIndex++)
+		{
+			DotOceanLevel[DotIndex] -= DotWorld[DotIndex].Z;
+		}
+
+		FVaOceanHullForces HullForces;
+		State.Hull->ComputeForces(&DotWorld[FirstDot], &DotOceanLevel[FirstDot], State.CenterOfMass, State.WaterPressure, &HullScratch[State.FirstScratch], HullForces);
+
+		State.Force = HullForces.Force;
+		State.Torque = HullForces.Torque;
+		State.SubmergedVolume = HullForces.SubmergedVolume;
+		State.CenterOfBuoyancy = HullForces.CenterOfBuoyancy;
+		return;
+	}
+
+	//
+	// Dot forces
+	//
+
+	const float TensionDepthFactor = State.Body->TensionDepthFactor;
+	const float WaveDragFactor = State.Body->WaveDragFactor;
+
+	for (int32 DotIndex = FirstDot; DotIndex < LastDot; DotIndex++)
+	{
+		const FVector& TensionDotWorld = DotWorld[DotIndex];
+
+		// Don't process dots above water
+		const float DotAltitude = TensionDotWorld.Z - DotOceanLevel[DotIndex];
+		if (DotAltitude > 0)
+		{
+			continue;
+		}
+
+		FVector WaveForce = FVector(0.0f, 0.0f, (-DotAltitude) * TensionDepthFactor);
+
+		// Orbital flow of waves (in m/sec!) pushes the dot with dynamic pressure (0.515 * |V|^2).
+		// Hull drag from ship own movement is handled by vehicle movement.
+		const FVector& WaveVelocity = DotWaveVelocity[DotIndex];
+		WaveForce += WaveVelocity.SafeNormal() * (0.515f * WaveVelocity.SizeSquared() * WaveDragFactor);
+
+		WaveForce *= State.ForceScale;
+
+		State.Force += WaveForce;
+		State.Torque += (TensionDotWorld - State.CenterOfMass) ^ WaveForce;
+	}
+}
+
+void FVaOceanBuoyancyManager::ApplyForces(float DeltaTime)
+{
+	for (const FBodyState& State : BodyStates)
+	{
+		UVaOceanBuoyancyComponent* Body = State.Body;
+
+		// Coarse LODs need the altitude from the first frame, full one keeps it up to date
+		if (State.NumDots > 0 && (State.LOD == EVaOceanBuoyancyLOD::Full || !Body->bRestAltitudeValid))
+		{
+			Body->UpdateRestAltitude(State.Location.Z - State.MeanOceanLevel, DeltaTime);
+		}
+
+		if (State.LOD == EVaOceanBuoyancyLOD::Kinematic)
+		{
+			Body->GetOwner()->SetActorLocationAndRotation(State.KinematicLocation, State.KinematicRotation.Rotator());
+
+			if (State.bDisturbed)
+			{
+				Body->WakeBuoyancy();
+			}
+			continue;
+		}
+
+		if (State.LOD == EVaOceanBuoyancyLOD::SinglePoint)
+		{
+			Body->UpdatedComponent->SetPhysicsLinearVelocity(State.DeltaLinearVelocity, true);
+			Body->UpdatedComponent->SetPhysicsAngularVelocity(State.DeltaAngularVelocity, true);
+			continue;
+		}
+
+		if (State.Hydrostatics || State.Hull)
+		{
+			Body->SubmergedVolume = State.SubmergedVolume;
+			Body->CenterOfBuoyancy = State.CenterOfBuoyancy;
+			Body->WaterplaneArea = State.WaterplaneArea;
+		}
+
+		if (!State.Force.IsZero())
+		{
+			Body->UpdatedComponent->AddForce(State.Force);
+			Body->UpdatedComponent->AddTorque(State.Torque);
+		}
+
+		// Static metacentric forces (can be useful on small waves), hydrostatic tables give the righting moment themselves
+		if (Body->bUseMetacentricForces && State.Hydrostatics == NULL)
+		{
+			Body->ApplyMetacentricForces(DeltaTime, State.AxisX, State.AxisY);
+		}
+	}
+}
+
+float FVaOceanBuoyancyManager::GetViewDistance(const FVector& Location) const
+{
+	if (ViewLocations.Num() == 0)
+	{
+		return 0.0f;
+	}
+
+	float MinDistSquared = MAX_flt;
+	for (int32 ViewIndex = 0; ViewIndex < ViewLocations.Num(); ViewIndex++)
+	{
+		MinDistSquared = FMath::Min(MinDistSquared, FVector::DistSquared(Location, ViewLocations[ViewIndex]));
+	}
+
+	return FMath::Sqrt(MinDistSquared);
+}
@@ -0,0 +1,266 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+/** Two complex numbers in register multiplied by the same twiddle */
+FORCEINLINE static VectorRegister VaComplexMultiply(const VectorRegister& A, const VectorRegister& WRe, const VectorRegister& WIm)
+{
+	return VectorMultiplyAdd(VectorSwizzle(A, 1, 0, 3, 2), WIm, VectorMultiply(A, WRe));
+}
+
+/** Radix-2 butterfly: (A + W * B, A - W * B) */
+FORCEINLINE static void VaButterfly(VectorRegister& A, VectorRegister& B, const VectorRegister& WRe, const VectorRegister& WIm)
+{
+	const VectorRegister T = VaComplexMultiply(B, WRe, WIm);
+	B = VectorSubtract(A, T);
+	A = VectorAdd(A, T);
+}
+
+FVaOceanFFT::FVaOceanFFT()
+	: Dim(0)
+{
+}
+
+void FVaOceanFFT::Init(int32 InDim)
+{
+	check(FMath::IsPowerOfTwo(InDim) && InDim >= 2);
+
+	Dim = InDim;
+	const int32 NumLevels = FMath::FloorLog2(Dim);
+
+	BitReverse.Empty(Dim);
+	BitReverse.AddUninitialized(Dim);
+	for (int32 i = 0; i < Dim; i++)
+	{
+		int32 Reversed = 0;
+		for (int32 Bit = 0; Bit < NumLevels; Bit++)
+		{
+			Reversed |= ((i >> Bit) & 1) << (NumLevels - 1 - Bit);
+		}
+		BitReverse[i] = Reversed;
+	}
+
+	Stages.Empty();
+	TwiddleRe.Empty();
+	TwiddleIm.Empty();
+
+	// W(k, M) = exp(2 * pi * i * k / M)
+	struct FTwiddleBuilder
+	{
+		TArray<VectorRegister>& Re;
+		TArray<VectorRegister>& Im;
+		FTwiddleBuilder(TArray<VectorRegister>& InRe, TArray<VectorRegister>& InIm) : Re(InRe), Im(InIm) {}
+
+		void Add(int32 K, int32 M)
+		{
+			float S, C;
+			FMath::SinCos(&S, &C, 2.0f * PI * K / M);
+			Re.Add(VectorSetFloat1(C));
+			Im.Add(MakeVectorRegister(-S, S, -S, S));
+		}
+	};
+	FTwiddleBuilder Twiddles(TwiddleRe, TwiddleIm);
+
+	// Radix-2 levels that don't fit into radix-8 go first
+	int32 Span = 1;
+	for (int32 Level = 0; Level < NumLevels % 3; Level++)
+	{
+		FStage Stage;
+		Stage.Levels = 1;
+		Stage.Span = Span;
+		Stage.FirstTwiddle = TwiddleRe.Num();
+		Stages.Add(Stage);
+
+		for (int32 j = 0; j < Span; j++)
+		{
+			Twiddles.Add(j, 2 * Span);
+		}
+
+		Span *= 2;
+	}
+
+	for (int32 Level = 0; Level < NumLevels / 3; Level++)
+	{
+		FStage Stage;
+		Stage.Levels = 3;
+		Stage.Span = Span;
+		Stage.FirstTwiddle = TwiddleRe.Num();
+		Stages.Add(Stage);
+
+		// Seven twiddles per butterfly: one for each pair of the three fused levels
+		for (int32 j = 0; j < Span; j++)
+		{
+			Twiddles.Add(j, 2 * Span);
+			Twiddles.Add(j, 4 * Span);
+			Twiddles.Add(j + Span, 4 * Span);
+			Twiddles.Add(j, 8 * Span);
+			Twiddles.Add(j + Span, 8 * Span);
+			Twiddles.Add(j + 2 * Span, 8 * Span);
+			Twiddles.Add(j + 3 * Span, 8 * Span);
+		}
+
+		Span *= 8;
+	}
+
+	check(Span == Dim);
+}
+
+int32 FVaOceanFFT::GetDimension() const
+{
+	return Dim;
+}
+
+void FVaOceanFFT::Inverse2D(FVector2D* const* Grids, int32 NumGrids) const
+{
+	check(Dim > 0);
+
+	TransformLines(Grids, NumGrids, false);
+	TransformLines(Grids, NumGrids, true);
+}
+
+void FVaOceanFFT::Inverse2D(TArray<FVector2D>& Grid) const
+{
+	check(Grid.Num() == Dim * Dim);
+
+	FVector2D* GridPtr = Grid.GetTypedData();
+	Inverse2D(&GridPtr, 1);
+}
+
+void FVaOceanFFT::InverseRows(FVector2D* const* Grids, int32 NumGrids) const
+{
+	check(Dim > 0);
+
+	TransformLines(Grids, NumGrids, false);
+}
+
+void FVaOceanFFT::InverseColumns(FVector2D* const* Grids, int32 NumGrids) const
+{
+	check(Dim > 0);
+
+	TransformLines(Grids, NumGrids, true);
+}
+
+void FVaOceanFFT::TransformLines(FVector2D* const* Grids, int32 NumGrids, bool bColumns) const
+{
+	const int32 PairsPerGrid = Dim / 2;
+
+	VaOceanParallelFor(NumGrids * PairsPerGrid, [&](int32 Job)
+	{
+		FVector2D* Grid = Grids[Job / PairsPerGrid];
+		const int32 Line = (Job % PairsPerGrid) * 2;
+
+		TArray<VectorRegister, TInlineAllocator<512> > Scratch;
+		Scratch.AddUninitialized(Dim);
+		VectorRegister* ScratchData = Scratch.GetTypedData();
+
+		if (bColumns)
+		{
+			// Two neighbour columns are already interleaved in memory
+			for (int32 k = 0; k < Dim; k++)
+			{
+				ScratchData[BitReverse[k]] = VectorLoad(&Grid[k * Dim + Line].X);
+			}
+
+			TransformPair(ScratchData);
+
+			for (int32 k = 0; k < Dim; k++)
+			{
+				VectorStore(ScratchData[k], &Grid[k * Dim + Line].X);
+			}
+		}
+		else
+		{
+			FVector2D* Row0 = Grid + Line * Dim;
+			FVector2D* Row1 = Row0 + Dim;
+
+			for (int32 k = 0; k < Dim; k++)
+			{
+				ScratchData[BitReverse[k]] = MakeVectorRegister(Row0[k].X, Row0[k].Y, Row1[k].X, Row1[k].Y);
+			}
+
+			TransformPair(ScratchData);
+
+			for (int32 k = 0; k < Dim; k++)
+			{
+				float Values[4];
+				VectorStore(ScratchData[k], Values);
+				Row0[k] = FVector2D(Values[0], Values[1]);
+				Row1[k] = FVector2D(Values[2], Values[3]);
+			}
+		}
+	}, 8);
+}
+
+void FVaOceanFFT::TransformPair(VectorRegister* Data) const
+{
+	for (const FStage& Stage : Stages)
+	{
+		if (Stage.Levels == 3)
+		{
+			RadixStage8(Data, Stage);
+		}
+		else
+		{
+			RadixStage2(Data, Stage);
+		}
+	}
+}
+
+void FVaOceanFFT::RadixStage2(VectorRegister* Data, const FStage& Stage) const
+{
+	const int32 L = Stage.Span;
+	const VectorRegister* Re = &TwiddleRe[Stage.FirstTwiddle];
+	const VectorRegister* Im = &TwiddleIm[Stage.FirstTwiddle];
+
+	for (int32 i = 0; i < Dim; i += 2 * L)
+	{
+		for (int32 j = 0; j < L; j++)
+		{
+			VaButterfly(Data[i + j], Data[i + j + L], Re[j], Im[j]);
+		}
+	}
+}
+
+void FVaOceanFFT::RadixStage8(VectorRegister* Data, const FStage& Stage) const
+{
+	const int32 L = Stage.Span;
+
+	for (int32 i = 0; i < Dim; i += 8 * L)
+	{
+		for (int32 j = 0; j < L; j++)
+		{
+			const VectorRegister* Re = &TwiddleRe[Stage.FirstTwiddle + j * 7];
+			const VectorRegister* Im = &TwiddleIm[Stage.FirstTwiddle + j * 7];
+
+			VectorRegister* Base = Data + i + j;
+			VectorRegister D[8];
+			for (int32 m = 0; m < 8; m++)
+			{
+				D[m] = Base[m * L];
+			}
+
+			// First level: span L
+			VaButterfly(D[0], D[1], Re[0], Im[0]);
+			VaButterfly(D[2], D[3], Re[0], Im[0]);
+			VaButterfly(D[4], D[5], Re[0], Im[0]);
+			VaButterfly(D[6], D[7], Re[0], Im[0]);
+
+			// Second level: span 2L
+			VaButterfly(D[0], D[2], Re[1], Im[1]);
+			VaButterfly(D[1], D[3], Re[2], Im[2]);
+			VaButterfly(D[4], D[6], Re[1], Im[1]);
+			VaButterfly(D[5], D[7], Re[2], Im[2]);
+
+			// Third level: span 4L
+			VaButterfly(D[0], D[4], Re[3], Im[3]);
+			VaButterfly(D[1], D[5], Re[4], Im[4]);
+			VaButterfly(D[2], D[6], Re[5], Im[5]);
+			VaButterfly(D[3], D[7], Re[6], Im[6]);
+
+			for (int32 m = 0; m < 8; m++)
+			{
+				Base[m * L] = D[m];
+			}
+		}
+	}
+}
@@ -0,0 +1,68 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+/**
+ * Unnormalized inverse complex FFT with exp(+2 * pi * i * k * n / N) kernel, same as VaOcean_FFT.usf.
+ *
+ * Levels are fused into radix-8 butterflies (with radix-2 remainder), each SIMD register holds
+ * two independent transforms: two rows or two columns of the grid at once. Row and column
+ * pairs are spread over task graph workers when called from game thread.
+ */
+class FVaOceanFFT
+{
+public:
+	FVaOceanFFT();
+
+	/** Precompute bit reversal and twiddle tables for desired dimension (power of two) */
+	void Init(int32 InDim);
+
+	/** Transform dimension */
+	int32 GetDimension() const;
+
+	/** In-place 2D transform of Dim x Dim grids. All grids are processed in the same parallel passes. */
+	void Inverse2D(FVector2D* const* Grids, int32 NumGrids) const;
+
+	/** In-place 2D transform of one grid */
+	void Inverse2D(TArray<FVector2D>& Grid) const;
+
+	/** In-place 1D transforms of all rows or all columns, the two passes of Inverse2D */
+	void InverseRows(FVector2D* const* Grids, int32 NumGrids) const;
+	void InverseColumns(FVector2D* const* Grids, int32 NumGrids) const;
+
+private:
+	/** Fused butterfly stage */
+	struct FStage
+	{
+		/** Number of fused radix-2 levels: 1 or 3 */
+		int32 Levels;
+
+		/** Distance between butterfly inputs of the first fused level */
+		int32 Span;
+
+		/** Offset of stage twiddles in twiddle table */
+		int32 FirstTwiddle;
+	};
+
+	/** Transform of two interleaved sequences, input is in bit-reversed order */
+	void TransformPair(VectorRegister* Data) const;
+
+	/** Run fused butterfly stage */
+	void RadixStage2(VectorRegister* Data, const FStage& Stage) const;
+	void RadixStage8(VectorRegister* Data, const FStage& Stage) const;
+
+	/** Transform rows or columns (by pairs) of all grids */
+	void TransformLines(FVector2D* const* Grids, int32 NumGrids, bool bColumns) const;
+
+	int32 Dim;
+
+	/** Bit reversed index for each input position */
+	TArray<int32> BitReverse;
+
+	/** Stages from the smallest span to the largest one */
+	TArray<FStage> Stages;
+
+	/** Twiddles as broadcast registers: (re, re, re, re) and (-im, im, -im, im) for each one */
+	TArray<VectorRegister> TwiddleRe;
+	TArray<VectorRegister> TwiddleIm;
+};
@@ -0,0 +1,317 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanHullForces
+
+FVaOceanHullForces::FVaOceanHullForces()
+	: Force(FVector::ZeroVector)
+	, Torque(FVector::ZeroVector)
+	, SubmergedVolume(0.0f)
+	, CenterOfBuoyancy(FVector::ZeroVector)
+{
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanHullMesh
+
+/** Append submerged triangle to scratch streams */
+static FORCEINLINE void AddSubmergedTriangle(float** Streams, int32& NumTriangles, const FVector& P0, const FVector& P1, const FVector& P2, float D0, float D1, float D2)
+{
+	const float Values[] = { P0.X, P0.Y, P0.Z, P1.X, P1.Y, P1.Z, P2.X, P2.Y, P2.Z, D0, D1, D2 };
+	for (int32 Stream = 0; Stream < ARRAY_COUNT(Values); Stream++)
+	{
+		Streams[Stream][NumTriangles] = Values[Stream];
+	}
+
+	NumTriangles++;
+}
+
+FVaOceanHullMesh::FVaOceanHullMesh()
+{
+}
+
+bool FVaOceanHullMesh::InitFromStaticMesh(UStaticMesh* Mesh)
+{
+	Vertices.Reset();
+	Indices.Reset();
+
+	if (Mesh == NULL || Mesh->RenderData == NULL || Mesh->RenderData->LODResources.Num() == 0)
+	{
+		return false;
+	}
+
+	const FStaticMeshLODResources& LOD = Mesh->RenderData->LODResources[0];
+	const int32 NumMeshVertices = LOD.PositionVertexBuffer.GetNumVertices();
+
+	TArray<uint32> MeshIndices;
+	LOD.IndexBuffer.GetCopy(MeshIndices);
+
+	// Render vertices are split by UV seams and hard edges, each position should be sampled once
+	TMap<FVector, int32> WeldedVertices;
+	TArray<int32> VertexRemap;
+	VertexRemap.AddUninitialized(NumMeshVertices);
+
+	for (int32 VertexIndex = 0; VertexIndex < NumMeshVertices; VertexIndex++)
+	{
+		const FVector& Position = LOD.PositionVertexBuffer.VertexPosition(VertexIndex);
+
+		const int32* WeldedIndex = WeldedVertices.Find(Position);
+		if (WeldedIndex)
+		{
+			VertexRemap[VertexIndex] = *WeldedIndex;
+		}
+		else
+		{
+			VertexRemap[VertexIndex] = Vertices.Add(Position);
+			WeldedVertices.Add(Position, VertexRemap[VertexIndex]);
+		}
+	}
+
+	float SignedVolume = 0.0f;
+	for (int32 Index = 0; Index + 2 < MeshIndices.Num(); Index += 3)
+	{
+		if (MeshIndices[Index] >= (uint32)NumMeshVertices || MeshIndices[Index + 1] >= (uint32)NumMeshVertices || MeshIndices[Index + 2] >= (uint32)NumMeshVertices)
+		{
+			continue;
+		}
+
+		const int32 A = VertexRemap[MeshIndices[Index]];
+		const int32 B = VertexRemap[MeshIndices[Index + 1]];
+		const int32 C = VertexRemap[MeshIndices[Index + 2]];
+
+		// Welding can collapse tiny triangles
+		if (A == B || B == C || C == A)
+		{
+			continue;
+		}
+
+		Indices.Add(A);
+		Indices.Add(B);
+		Indices.Add(C);
+
+		SignedVolume += Vertices[A] | (Vertices[B] ^ Vertices[C]);
+	}
+
+	// Normals are taken as cross product of edges, they point out of hull when its volume is positive
+	if (SignedVolume < 0.0f)
+	{
+		for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+		{
+			Swap(Indices[Index + 1], Indices[Index + 2]);
+		}
+	}
+
+	if (FMath::Abs(SignedVolume) < KINDA_SMALL_NUMBER)
+	{
+		UE_LOG(LogVaOceanPhysics, Warning, TEXT("Hull mesh %s has no volume, it should be closed"), *Mesh->GetName());
+	}
+
+	UE_LOG(LogVaOceanPhysics, Log, TEXT("Hull mesh %s: %d vertices, %d triangles"), *Mesh->GetName(), Vertices.Num(), GetNumTriangles());
+
+	return IsValid();
+}
+
+bool FVaOceanHullMesh::IsValid() const
+{
+	return Indices.Num() > 0;
+}
+
+const TArray<FVector>& FVaOceanHullMesh::GetVertices() const
+{
+	return Vertices;
+}
+
+int32 FVaOceanHullMesh::GetNumTriangles() const
+{
+	return Indices.Num() / 3;
+}
+
+int32 FVaOceanHullMesh::GetScratchCapacity() const
+{
+	return (2 * GetNumTriangles() + VAOCEAN_SIMD_WIDTH - 1) / VAOCEAN_SIMD_WIDTH * VAOCEAN_SIMD_WIDTH;
+}
+
+int32 FVaOceanHullMesh::GetScratchSize() const
+{
+	return SS_Num * GetScratchCapacity();
+}
+
+void FVaOceanHullMesh::ComputeForces(const FVector* WorldVertices, const float* Depths, const FVector& CenterOfMass, float WaterPressure, float* Scratch, FVaOceanHullForces& OutForces) const
+{
+	OutForces = FVaOceanHullForces();
+	OutForces.CenterOfBuoyancy = CenterOfMass;
+
+	const int32 Capacity = GetScratchCapacity();
+	float* Streams[SS_Num];
+	for (int32 Stream = 0; Stream < SS_Num; Stream++)
+	{
+		Streams[Stream] = Scratch + Stream * Capacity;
+	}
+
+	//
+	// Clip triangles by water, cut points are found on edges where linear depth is zero
+	//
+
+	int32 NumSubmerged = 0;
+	for (int32 Index = 0; Index < Indices.Num(); Index += 3)
+	{
+		const int32 Corners[3] = { Indices[Index], Indices[Index + 1], Indices[Index + 2] };
+
+		int32 NumCornersBelow = 0;
+		int32 LastBelow = 0;
+		int32 LastAbove = 0;
+		for (int32 Corner = 0; Corner < 3; Corner++)
+		{
+			if (Depths[Corners[Corner]] > 0.0f)
+			{
+				NumCornersBelow++;
+				LastBelow = Corner;
+			}
+			else
+			{
+				LastAbove = Corner;
+			}
+		}
+
+		if (NumCornersBelow == 0)
+		{
+			continue;
+		}
+
+		if (NumCornersBelow == 3)
+		{
+			AddSubmergedTriangle(Streams, NumSubmerged,
+				WorldVertices[Corners[0]], WorldVertices[Corners[1]], WorldVertices[Corners[2]],
+				Depths[Corners[0]], Depths[Corners[1]], Depths[Corners[2]]);
+			continue;
+		}
+
+		// Corners are rotated, so winding (and the normal direction) is kept
+		if (NumCornersBelow == 1)
+		{
+			const int32 A = Corners[LastBelow];
+			const int32 B = Corners[(LastBelow + 1) % 3];
+			const int32 C = Corners[(LastBelow + 2) % 3];
+
+			const FVector CutAB = FMath::Lerp(WorldVertices[A], WorldVertices[B], Depths[A] / (Depths[A] - Depths[B]));
+			const FVector CutAC = FMath::Lerp(WorldVertices[A], WorldVertices[C], Depths[A] / (Depths[A] - Depths[C]));
+
+			AddSubmergedTriangle(Streams, NumSubmerged, WorldVertices[A], CutAB, CutAC, Depths[A], 0.0f, 0.0f);
+		}
+		else
+		{
+			const int32 A = Corners[(LastAbove + 1) % 3];
+			const int32 B = Corners[(LastAbove + 2) % 3];
+			const int32 C = Corners[LastAbove];
+
+			const FVector CutBC = FMath::Lerp(WorldVertices[B], WorldVertices[C], Depths[B] / (Depths[B] - Depths[C]));
+			const FVector CutAC = FMath::Lerp(WorldVertices[A], WorldVertices[C], Depths[A] / (Depths[A] - Depths[C]));
+
+			// Submerged quad is split into two triangles
+			AddSubmergedTriangle(Streams, NumSubmerged, WorldVertices[A], WorldVertices[B], CutBC, Depths[A], Depths[B], 0.0f);
+			AddSubmergedTriangle(Streams, NumSubmerged, WorldVertices[A], CutBC, CutAC, Depths[A], 0.0f, 0.0f);
+		}
+	}
+
+	if (NumSubmerged == 0)
+	{
+		return;
+	}
+
+	// Degenerate triangles fill the last register, they give zero area
+	while (NumSubmerged % VAOCEAN_SIMD_WIDTH != 0)
+	{
+		AddSubmergedTriangle(Streams, NumSubmerged, FVector::ZeroVector, FVector::ZeroVector, FVector::ZeroVector, 0.0f, 0.0f, 0.0f);
+	}
+
+	//
+	// Integrate pressure: depth is linear over triangle, so integrals of depth and depth-weighted position are exact
+	//
+
+	const VectorRegister Third = VectorSetFloat1(1.0f / 3.0f);
+	const VectorRegister Half = VectorSetFloat1(0.5f);
+	const VectorRegister Twelfth = VectorSetFloat1(1.0f / 12.0f);
+	const VectorRegister TwentyFourth = VectorSetFloat1(1.0f / 24.0f);
+
+	// Cross product of edges is twice the area vector, pressure pushes against it
+	const VectorRegister PressureScale = VectorSetFloat1(-0.5f * WaterPressure);
+
+	const VectorRegister COMX = VectorSetFloat1(CenterOfMass.X);
+	const VectorRegister COMY = VectorSetFloat1(CenterOfMass.Y);
+	const VectorRegister COMZ = VectorSetFloat1(CenterOfMass.Z);
+
+	VectorRegister ForceX = VectorZero(), ForceY = VectorZero(), ForceZ = VectorZero();
+	VectorRegister TorqueX = VectorZero(), TorqueY = VectorZero(), TorqueZ = VectorZero();
+	VectorRegister Volume = VectorZero();
+	VectorRegister MomentX = VectorZero(), MomentY = VectorZero(), MomentZ = VectorZero();
+
+	for (int32 Index = 0; Index < NumSubmerged; Index += VAOCEAN_SIMD_WIDTH)
+	{
+		// Vertices relative to center of mass
+		const VectorRegister X0 = VectorSubtract(VectorLoad(&Streams[SS_X0][Index]), COMX);
+		const VectorRegister Y0 = VectorSubtract(VectorLoad(&Streams[SS_Y0][Index]), COMY);
+		const VectorRegister Z0 = VectorSubtract(VectorLoad(&Streams[SS_Z0][Index]), COMZ);
+		const VectorRegister X1 = VectorSubtract(VectorLoad(&Streams[SS_X1][Index]), COMX);
+		const VectorRegister Y1 = VectorSubtract(VectorLoad(&Streams[SS_Y1][Index]), COMY);
+		const VectorRegister Z1 = VectorSubtract(VectorLoad(&Streams[SS_Z1][Index]), COMZ);
+		const VectorRegister X2 = VectorSubtract(VectorLoad(&Streams[SS_X2][Index]), COMX);
+		const VectorRegister Y2 = VectorSubtract(VectorLoad(&Streams[SS_Y2][Index]), COMY);
+		const VectorRegister Z2 = VectorSubtract(VectorLoad(&Streams[SS_Z2][Index]), COMZ);
+		const VectorRegister D0 = VectorLoad(&Streams[SS_D0][Index]);
+		const VectorRegister D1 = VectorLoad(&Streams[SS_D1][Index]);
+		const VectorRegister D2 = VectorLoad(&Streams[SS_D2][Index]);
+
+		// Outward normal scaled by twice the area
+		const VectorRegister E1X = VectorSubtract(X1, X0), E1Y = VectorSubtract(Y1, Y0), E1Z = VectorSubtract(Z1, Z0);
+		const VectorRegister E2X = VectorSubtract(X2, X0), E2Y = VectorSubtract(Y2, Y0), E2Z = VectorSubtract(Z2, Z0);
+		const VectorRegister NX = VectorSubtract(VectorMultiply(E1Y, E2Z), VectorMultiply(E1Z, E2Y));
+		const VectorRegister NY = VectorSubtract(VectorMultiply(E1Z, E2X), VectorMultiply(E1X, E2Z));
+		const VectorRegister NZ = VectorSubtract(VectorMultiply(E1X, E2Y), VectorMultiply(E1Y, E2X));
+
+		// Pressure force of unit depth
+		const VectorRegister PX = VectorMultiply(NX, PressureScale);
+		const VectorRegister PY = VectorMultiply(NY, PressureScale);
+		const VectorRegister PZ = VectorMultiply(NZ, PressureScale);
+
+		// Force = P * mean depth
+		const VectorRegister DepthSum = VectorAdd(VectorAdd(D0, D1), D2);
+		const VectorRegister MeanDepth = VectorMultiply(DepthSum, Third);
+		ForceX = VectorMultiplyAdd(PX, MeanDepth, ForceX);
+		ForceY = VectorMultiplyAdd(PY, MeanDepth, ForceY);
+		ForceZ = VectorMultiplyAdd(PZ, MeanDepth, ForceZ);
+
+		// Depth-weighted position (per unit area): (Sum(R * D) + Sum(R) * Sum(D)) / 12
+		const VectorRegister QX = VectorMultiply(VectorMultiplyAdd(VectorAdd(VectorAdd(X0, X1), X2), DepthSum, VectorMultiplyAdd(X0, D0, VectorMultiplyAdd(X1, D1, VectorMultiply(X2, D2)))), Twelfth);
+		const VectorRegister QY = VectorMultiply(VectorMultiplyAdd(VectorAdd(VectorAdd(Y0, Y1), Y2), DepthSum, VectorMultiplyAdd(Y0, D0, VectorMultiplyAdd(Y1, D1, VectorMultiply(Y2, D2)))), Twelfth);
+		const VectorRegister QZ = VectorMultiply(VectorMultiplyAdd(VectorAdd(VectorAdd(Z0, Z1), Z2), DepthSum, VectorMultiplyAdd(Z0, D0, VectorMultiplyAdd(Z1, D1, VectorMultiply(Z2, D2)))), Twelfth);
+
+		// Torque = Q x P, pressure is applied at center of pressure, not at centroid
+		TorqueX = VectorAdd(TorqueX, VectorSubtract(VectorMultiply(QY, PZ), VectorMultiply(QZ, PY)));
+		TorqueY = VectorAdd(TorqueY, VectorSubtract(VectorMultiply(QZ, PX), VectorMultiply(QX, PZ)));
+		TorqueZ = VectorAdd(TorqueZ, VectorSubtract(VectorMultiply(QX, PY), VectorMultiply(QY, PX)));
+
+		// Water column between triangle and surface has projected area and mean depth.
+		// Columns over upward facing triangles are negative, so closed hull sums to displaced volume.
+		const VectorRegister ProjectedArea = VectorNegate(VectorMultiply(NZ, Half));
+		Volume = VectorMultiplyAdd(ProjectedArea, MeanDepth, Volume);
+
+		// Column moment: Q horizontally, vertically also half of squared depth integral (Sum(D * D) + Sum(D)^2) / 24
+		const VectorRegister HalfSquaredDepth = VectorMultiply(VectorMultiplyAdd(DepthSum, DepthSum, VectorMultiplyAdd(D0, D0, VectorMultiplyAdd(D1, D1, VectorMultiply(D2, D2)))), TwentyFourth);
+		MomentX = VectorMultiplyAdd(ProjectedArea, QX, MomentX);
+		MomentY = VectorMultiplyAdd(ProjectedArea, QY, MomentY);
+		MomentZ = VectorMultiplyAdd(ProjectedArea, VectorAdd(QZ, HalfSquaredDepth), MomentZ);
+	}
+
+	OutForces.Force = FVector(VaVectorHorizontalSum(ForceX), VaVectorHorizontalSum(ForceY), VaVectorHorizontalSum(ForceZ));
+	OutForces.Torque = FVector(VaVectorHorizontalSum(TorqueX), VaVectorHorizontalSum(TorqueY), VaVectorHorizontalSum(TorqueZ));
+	OutForces.SubmergedVolume = VaVectorHorizontalSum(Volume);
+
+	if (OutForces.SubmergedVolume > KINDA_SMALL_NUMBER)
+	{
+		const FVector Moment(VaVectorHorizontalSum(MomentX), VaVectorHorizontalSum(MomentY), VaVectorHorizontalSum(MomentZ));
+		OutForces.CenterOfBuoyancy = CenterOfMass + Moment / OutForces.SubmergedVolume;
+	}
+}
@@ -0,0 +1,208 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+/** Baked tables of hull meshes, stale ones are removed when new mesh is baked */
+static TMap<TWeakObjectPtr<UStaticMesh>, FVaOceanHydrostaticsPtr> GVaOceanHydrostatics;
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanHydrostaticSample
+
+FVaOceanHydrostaticSample::FVaOceanHydrostaticSample()
+	: Volume(0.0f)
+	, CenterOfBuoyancy(FVector::ZeroVector)
+	, WaterplaneArea(0.0f)
+{
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanHydrostatics
+
+const float FVaOceanHydrostatics::MaxHeel = PI / 3.0f;
+const float FVaOceanHydrostatics::MaxTrim = PI / 6.0f;
+
+FVaOceanHydrostatics::FVaOceanHydrostatics()
+	: MinDraft(0.0f)
+	, MaxDraft(0.0f)
+{
+}
+
+FVaOceanHydrostaticsPtr FVaOceanHydrostatics::FindOrBake(UStaticMesh* Mesh, const FVaOceanHullMesh& Hull)
+{
+	check(IsInGameThread());
+
+	FVaOceanHydrostaticsPtr* Found = GVaOceanHydrostatics.Find(Mesh);
+	if (Found)
+	{
+		return *Found;
+	}
+
+	for (auto It = GVaOceanHydrostatics.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TSharedPtr<FVaOceanHydrostatics, ESPMode::ThreadSafe> Hydrostatics = MakeShareable(new FVaOceanHydrostatics());
+	Hydrostatics->Bake(Hull);
+
+	if (!Hydrostatics->IsValid())
+	{
+		return FVaOceanHydrostaticsPtr();
+	}
+
+	UE_LOG(LogVaOceanPhysics, Log, TEXT("Hydrostatic tables %dx%dx%d are baked for %s"), NumDrafts, NumHeels, NumTrims, *Mesh->GetName());
+
+	GVaOceanHydrostatics.Add(Mesh, Hydrostatics);
+	return Hydrostatics;
+}
+
+void FVaOceanHydrostatics::Bake(const FVaOceanHullMesh& Hull)
+{
+	Cells.Reset();
+	WaterPlanePoints.Reset();
+
+	if (!Hull.IsValid())
+	{
+		return;
+	}
+
+	const TArray<FVector>& Vertices = Hull.GetVertices();
+	const FBox Bounds(Vertices);
+
+	// The most tilted planes should pass below and above the whole hull too
+	const float MaxRise = FMath::Tan(MaxTrim) * FMath::Max(FMath::Abs(Bounds.Min.X), FMath::Abs(Bounds.Max.X)) +
+		FMath::Tan(MaxHeel) * FMath::Max(FMath::Abs(Bounds.Min.Y), FMath::Abs(Bounds.Max.Y));
+	MinDraft = Bounds.Min.Z - MaxRise;
+	MaxDraft = Bounds.Max.Z + MaxRise;
+
+	if (MaxDraft <= MinDraft)
+	{
+		return;
+	}
+
+	const float DraftStep = (MaxDraft - MinDraft) / (NumDrafts - 1);
+
+	TArray<float> Depths;
+	Depths.AddUninitialized(Vertices.Num());
+
+	TArray<float> Scratch;
+	Scratch.AddUninitialized(Hull.GetScratchSize());
+
+	Cells.AddZeroed(NumDrafts * NumHeels * NumTrims);
+
+	for (int32 TrimIndex = 0; TrimIndex < NumTrims; TrimIndex++)
+	{
+		const float TanTrim = FMath::Tan(-MaxTrim + 2.0f * MaxTrim * TrimIndex / (NumTrims - 1));
+
+		for (int32 HeelIndex = 0; HeelIndex < NumHeels; HeelIndex++)
+		{
+			const float TanHeel = FMath::Tan(-MaxHeel + 2.0f * MaxHeel * HeelIndex / (NumHeels - 1));
+
+			// Volume and its moment with unit pressure, hull origin is the reference point
+			for (int32 DraftIndex = 0; DraftIndex < NumDrafts; DraftIndex++)
+			{
+				const float Draft = MinDraft + DraftStep * DraftIndex;
+
+				for (int32 VertexIndex = 0; VertexIndex < Vertices.Num(); VertexIndex++)
+				{
+					const FVector& Vertex = Vertices[VertexIndex];
+					Depths[VertexIndex] = Draft + TanTrim * Vertex.X + TanHeel * Vertex.Y - Vertex.Z;
+				}
+
+				FVaOceanHullForces HullForces;
+				Hull.ComputeForces(Vertices.GetTypedData(), Depths.GetTypedData(), FVector::ZeroVector, 1.0f, Scratch.GetTypedData(), HullForces);
+
+				FCell& Cell = Cells[(TrimIndex * NumHeels + HeelIndex) * NumDrafts + DraftIndex];
+				Cell.Volume = FMath::Max(HullForces.SubmergedVolume, 0.0f);
+				Cell.VolumeMoment = HullForces.CenterOfBuoyancy * Cell.Volume;
+			}
+
+			// Waterplane area is derivative of volume by plane shift, plane moves along its normal by DraftStep * NormalZ
+			const float NormalZ = FMath::InvSqrt(1.0f + FMath::Square(TanTrim) + FMath::Square(TanHeel));
+
+			for (int32 DraftIndex = 0; DraftIndex < NumDrafts; DraftIndex++)
+			{
+				const int32 PrevIndex = FMath::Max(DraftIndex - 1, 0);
+				const int32 NextIndex = FMath::Min(DraftIndex + 1, NumDrafts - 1);
+
+				FCell& Cell = Cells[(TrimIndex * NumHeels + HeelIndex) * NumDrafts + DraftIndex];
+				Cell.WaterplaneArea = FMath::Max(GetCell(NextIndex, HeelIndex, TrimIndex).Volume - GetCell(PrevIndex, HeelIndex, TrimIndex).Volume, 0.0f) /
+					((NextIndex - PrevIndex) * DraftStep * NormalZ);
+			}
+		}
+	}
+
+	// Mean water plane is fitted to ocean at hull extremities
+	const FVector Center = Bounds.GetCenter();
+	WaterPlanePoints.Add(FVector(Center.X, Center.Y, 0.0f));
+	WaterPlanePoints.Add(FVector(Bounds.Max.X, Center.Y, 0.0f));
+	WaterPlanePoints.Add(FVector(Bounds.Min.X, Center.Y, 0.0f));
+	WaterPlanePoints.Add(FVector(Center.X, Bounds.Max.Y, 0.0f));
+	WaterPlanePoints.Add(FVector(Center.X, Bounds.Min.Y, 0.0f));
+}
+
+bool FVaOceanHydrostatics::IsValid() const
+{
+	return Cells.Num() > 0;
+}
+
+FVaOceanHydrostaticSample FVaOceanHydrostatics::Lookup(float Draft, float Heel, float Trim) const
+{
+	FVaOceanHydrostaticSample Result;
+
+	if (!IsValid())
+	{
+		return Result;
+	}
+
+	// Continuous table coordinates
+	const float DraftPos = FMath::Clamp((Draft - MinDraft) / (MaxDraft - MinDraft), 0.0f, 1.0f) * (NumDrafts - 1);
+	const float HeelPos = FMath::Clamp((Heel + MaxHeel) / (2.0f * MaxHeel), 0.0f, 1.0f) * (NumHeels - 1);
+	const float TrimPos = FMath::Clamp((Trim + MaxTrim) / (2.0f * MaxTrim), 0.0f, 1.0f) * (NumTrims - 1);
+
+	const int32 DraftIndex = FMath::Min(FMath::FloorToInt(DraftPos), NumDrafts - 2);
+	const int32 HeelIndex = FMath::Min(FMath::FloorToInt(HeelPos), NumHeels - 2);
+	const int32 TrimIndex = FMath::Min(FMath::FloorToInt(TrimPos), NumTrims - 2);
+
+	const float DraftAlpha = DraftPos - DraftIndex;
+	const float HeelAlpha = HeelPos - HeelIndex;
+	const float TrimAlpha = TrimPos - TrimIndex;
+
+	float Volume = 0.0f;
+	FVector VolumeMoment = FVector::ZeroVector;
+	float WaterplaneArea = 0.0f;
+
+	for (int32 Corner = 0; Corner < 8; Corner++)
+	{
+		const int32 DX = Corner & 1;
+		const int32 DY = (Corner >> 1) & 1;
+		const int32 DZ = (Corner >> 2) & 1;
+
+		const float Weight = (DX ? DraftAlpha : 1.0f - DraftAlpha) * (DY ? HeelAlpha : 1.0f - HeelAlpha) * (DZ ? TrimAlpha : 1.0f - TrimAlpha);
+		const FCell& Cell = GetCell(DraftIndex + DX, HeelIndex + DY, TrimIndex + DZ);
+
+		Volume += Cell.Volume * Weight;
+		VolumeMoment += Cell.VolumeMoment * Weight;
+		WaterplaneArea += Cell.WaterplaneArea * Weight;
+	}
+
+	Result.Volume = Volume;
+	Result.WaterplaneArea = WaterplaneArea;
+
+	if (Volume > KINDA_SMALL_NUMBER)
+	{
+		Result.CenterOfBuoyancy = VolumeMoment / Volume;
+	}
+
+	return Result;
+}
+
+const TArray<FVector>& FVaOceanHydrostatics::GetWaterPlanePoints() const
+{
+	return WaterPlanePoints;
+}
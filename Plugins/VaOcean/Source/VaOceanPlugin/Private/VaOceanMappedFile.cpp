@@ -0,0 +1,165 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+#if PLATFORM_WINDOWS
+	#include "AllowWindowsPlatformTypes.h"
+	#include <windows.h>
+	#include "HideWindowsPlatformTypes.h"
+	#define VAOCEAN_MMAP_WINDOWS 1
+	#define VAOCEAN_MMAP_POSIX 0
+#elif PLATFORM_LINUX || PLATFORM_MAC
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#define VAOCEAN_MMAP_WINDOWS 0
+	#define VAOCEAN_MMAP_POSIX 1
+#else
+	#define VAOCEAN_MMAP_WINDOWS 0
+	#define VAOCEAN_MMAP_POSIX 0
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Memory mapping
+
+/** Map whole file read-only. Handles are closed right away, the view keeps mapping alive. */
+static const uint8* MapFileReadOnly(const FString& Filename, int64& OutSize)
+{
+	OutSize = 0;
+
+#if VAOCEAN_MMAP_WINDOWS
+	HANDLE File = CreateFileW(*Filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (File == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+
+	LARGE_INTEGER FileSize;
+	if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+	{
+		CloseHandle(File);
+		return NULL;
+	}
+
+	HANDLE Mapping = CreateFileMappingW(File, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(File);
+	if (Mapping == NULL)
+	{
+		return NULL;
+	}
+
+	const uint8* Data = (const uint8*)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(Mapping);
+
+	if (Data)
+	{
+		OutSize = FileSize.QuadPart;
+	}
+	return Data;
+#elif VAOCEAN_MMAP_POSIX
+	const int File = open(TCHAR_TO_UTF8(*Filename), O_RDONLY);
+	if (File < 0)
+	{
+		return NULL;
+	}
+
+	struct stat FileStat;
+	if (fstat(File, &FileStat) != 0 || FileStat.st_size == 0)
+	{
+		close(File);
+		return NULL;
+	}
+
+	void* Data = mmap(NULL, FileStat.st_size, PROT_READ, MAP_SHARED, File, 0);
+	close(File);
+
+	if (Data == MAP_FAILED)
+	{
+		return NULL;
+	}
+
+	OutSize = FileStat.st_size;
+	return (const uint8*)Data;
+#else
+	return NULL;
+#endif
+}
+
+static void UnmapFile(const uint8* Data, int64 Size)
+{
+#if VAOCEAN_MMAP_WINDOWS
+	UnmapViewOfFile(Data);
+#elif VAOCEAN_MMAP_POSIX
+	munmap((void*)Data, Size);
+#endif
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanMappedFile
+
+FVaOceanMappedFile::FVaOceanMappedFile()
+	: MappedData(NULL)
+	, MappedSize(0)
+{
+}
+
+FVaOceanMappedFile::~FVaOceanMappedFile()
+{
+	Close();
+}
+
+bool FVaOceanMappedFile::Open(const FString& Filename)
+{
+	Close();
+
+	MappedData = MapFileReadOnly(Filename, MappedSize);
+	if (MappedData)
+	{
+		return true;
+	}
+
+	// Private copy is still better than nothing
+	if (!FFileHelper::LoadFileToArray(LoadedData, *Filename, FILEREAD_Silent))
+	{
+		LoadedData.Empty();
+		return false;
+	}
+
+	MappedSize = LoadedData.Num();
+	return true;
+}
+
+void FVaOceanMappedFile::Close()
+{
+	if (MappedData)
+	{
+		UnmapFile(MappedData, MappedSize);
+	}
+
+	MappedData = NULL;
+	MappedSize = 0;
+	LoadedData.Empty();
+}
+
+const uint8* FVaOceanMappedFile::GetData() const
+{
+	if (MappedData)
+	{
+		return MappedData;
+	}
+
+	return LoadedData.Num() > 0 ? LoadedData.GetTypedData() : NULL;
+}
+
+int64 FVaOceanMappedFile::GetSize() const
+{
+	return MappedSize;
+}
+
+bool FVaOceanMappedFile::IsMapped() const
+{
+	return MappedData != NULL;
+}
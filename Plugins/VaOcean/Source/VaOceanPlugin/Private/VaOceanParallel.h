@@ -0,0 +1,78 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+/** Task that runs functor for a range of indices */
+template<typename FunctorType>
+class TVaOceanParallelTask
+{
+public:
+	TVaOceanParallelTask(const FunctorType& InFunctor, int32 InFirst, int32 InLast)
+		: Functor(InFunctor)
+		, First(InFirst)
+		, Last(InLast)
+	{
+	}
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(TVaOceanParallelTask, STATGROUP_TaskGraphTasks);
+	}
+
+	static ENamedThreads::Type GetDesiredThread()
+	{
+		return ENamedThreads::AnyThread;
+	}
+
+	static ESubsequentsMode::Type GetSubsequentsMode()
+	{
+		return ESubsequentsMode::TrackSubsequents;
+	}
+
+	void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+	{
+		for (int32 Index = First; Index < Last; Index++)
+		{
+			Functor(Index);
+		}
+	}
+
+private:
+	const FunctorType& Functor;
+	int32 First;
+	int32 Last;
+};
+
+/**
+ * Call Functor(Index) for each index in [0, Num) spread over task graph workers.
+ * Calling thread does its own part and waits for the rest, so functor can be a stack object.
+ * Calls from worker threads run serially: waiting worker doesn't take other tasks, so nested fan-out could deadlock.
+ */
+template<typename FunctorType>
+void VaOceanParallelFor(int32 Num, const FunctorType& Functor, int32 MinBatchSize = 1)
+{
+	const int32 MaxBatches = (FTaskGraphInterface::IsRunning() && IsInGameThread()) ? FTaskGraphInterface::Get().GetNumWorkerThreads() + 1 : 1;
+	const int32 NumBatches = FMath::Clamp(Num / FMath::Max(MinBatchSize, 1), 1, MaxBatches);
+	const int32 BatchSize = (Num + NumBatches - 1) / NumBatches;
+
+	FGraphEventArray Tasks;
+	for (int32 Batch = 1; Batch < NumBatches; Batch++)
+	{
+		const int32 First = Batch * BatchSize;
+		const int32 Last = FMath::Min(First + BatchSize, Num);
+		if (First < Last)
+		{
+			Tasks.Add(TGraphTask< TVaOceanParallelTask<FunctorType> >::CreateTask().ConstructAndDispatchWhenReady(Functor, First, Last));
+		}
+	}
+
+	for (int32 Index = 0; Index < FMath::Min(BatchSize, Num); Index++)
+	{
+		Functor(Index);
+	}
+
+	if (Tasks.Num() > 0)
+	{
+		FTaskGraphInterface::Get().WaitUntilTasksComplete(Tasks);
+	}
+}
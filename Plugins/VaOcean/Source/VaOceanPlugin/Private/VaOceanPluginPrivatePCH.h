@@ -9,6 +9,7 @@
 #include "ShaderParameterUtils.h"
 #include "GlobalShader.h"
 #include "RHIStaticStates.h"
+#include "UnrealNetwork.h"
 
 // You should place include statements to your module's private header files here.  You only need to
 // add includes for headers that are used in most of your module's source files though.
@@ -18,8 +19,23 @@ DECLARE_LOG_CATEGORY_EXTERN(LogVaOcean, Log, All);
 DECLARE_LOG_CATEGORY_EXTERN(LogVaOceanPhysics, Log, All);
 
 #include "IVaOceanPlugin.h"
+#include "VaOceanSimd.h"
+#include "VaOceanParallel.h"
+#include "VaOceanFFT.h"
 
 #include "VaOceanTypes.h"
+#include "VaOceanSpectrum.h"
+#include "VaOceanMappedFile.h"
+#include "VaOceanSpectrumTables.h"
+#include "VaOceanBakedAnimation.h"
+#include "VaOceanSnapshot.h"
+#include "VaOceanRegistry.h"
+#include "VaOceanHull.h"
+#include "VaOceanHydrostatics.h"
+#include "VaOceanBuoyancyManager.h"
+#include "VaOceanSimulatorComponent.h"
 #include "VaOceanStateActor.h"
 #include "VaOceanStateActorSimple.h"
+#include "VaOceanStateActorGerstner.h"
+#include "VaOceanStateActorBaked.h"
 #include "VaOceanBuoyancyComponent.h"
@@ -0,0 +1,227 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+const float FVaOceanRegistry::CellSize = 100000.0f;
+
+/** Registries of all worlds, stale ones are removed on access */
+static TMap<TWeakObjectPtr<UWorld>, TSharedPtr<FVaOceanRegistry> > GVaOceanRegistries;
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanRegionHandle
+
+FVaOceanRegionHandle::FVaOceanRegionHandle()
+	: Cell(FIntPoint::ZeroValue)
+	, Revision(0)
+	, bUniformCell(false)
+{
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanRegistry
+
+FVaOceanRegistry::FVaOceanRegistry()
+	: Revision(1)
+{
+}
+
+FVaOceanRegistry& FVaOceanRegistry::Get(UWorld* World)
+{
+	check(IsInGameThread());
+
+	TSharedPtr<FVaOceanRegistry>* Registry = GVaOceanRegistries.Find(World);
+	if (Registry)
+	{
+		return **Registry;
+	}
+
+	// New world is a good moment to forget the destroyed ones
+	for (auto It = GVaOceanRegistries.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TSharedPtr<FVaOceanRegistry> NewRegistry = MakeShareable(new FVaOceanRegistry());
+	GVaOceanRegistries.Add(World, NewRegistry);
+
+	return *NewRegistry;
+}
+
+void FVaOceanRegistry::Register(AVaOceanStateActor* OceanStateActor)
+{
+	check(OceanStateActor);
+
+	// Update region if ocean is registered already
+	FRegion* Region = NULL;
+	for (FRegion& ExistingRegion : Regions)
+	{
+		if (ExistingRegion.OceanStateActor.Get() == OceanStateActor)
+		{
+			Region = &ExistingRegion;
+			break;
+		}
+	}
+
+	if (Region == NULL)
+	{
+		Region = new(Regions) FRegion();
+		Region->OceanStateActor = OceanStateActor;
+	}
+
+	Region->bUnbounded = !OceanStateActor->GetRegionBounds(Region->Bounds);
+	Region->Priority = OceanStateActor->GetRegionPriority();
+
+	RebuildIndex();
+}
+
+void FVaOceanRegistry::Unregister(AVaOceanStateActor* OceanStateActor)
+{
+	for (int32 i = Regions.Num() - 1; i >= 0; i--)
+	{
+		if (Regions[i].OceanStateActor.Get() == OceanStateActor)
+		{
+			Regions.RemoveAt(i);
+		}
+	}
+
+	RebuildIndex();
+}
+
+AVaOceanStateActor* FVaOceanRegistry::FindOcean(const FVector& Location) const
+{
+	const int32 RegionIndex = FindRegion(Location, Cells.Find(GetCell(Location)));
+	return (RegionIndex != INDEX_NONE) ? Regions[RegionIndex].OceanStateActor.Get() : NULL;
+}
+
+AVaOceanStateActor* FVaOceanRegistry::UpdateRegionHandle(FVaOceanRegionHandle& Handle, const FVector& Location) const
+{
+	const FIntPoint Cell = GetCell(Location);
+
+	// Ship is still in the same region
+	if (Handle.Revision == Revision && Handle.bUniformCell && Handle.Cell == Cell)
+	{
+		return Handle.OceanStateActor.Get();
+	}
+
+	const FCell* CellData = Cells.Find(Cell);
+	const int32 RegionIndex = FindRegion(Location, CellData);
+
+	Handle.OceanStateActor = (RegionIndex != INDEX_NONE) ? Regions[RegionIndex].OceanStateActor.Get() : NULL;
+	Handle.Cell = Cell;
+	Handle.Revision = Revision;
+	Handle.bUniformCell = (CellData == NULL || CellData->bUniform);
+
+	return Handle.OceanStateActor.Get();
+}
+
+uint32 FVaOceanRegistry::GetRevision() const
+{
+	return Revision;
+}
+
+FIntPoint FVaOceanRegistry::GetCell(const FVector& Location)
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+int32 FVaOceanRegistry::FindRegion(const FVector& Location, const FCell* Cell) const
+{
+	const FVector2D Point(Location.X, Location.Y);
+
+	// Cell candidates are sorted, so the first one that contains the point wins over bounded ones
+	int32 BestRegion = INDEX_NONE;
+	if (Cell)
+	{
+		for (int32 RegionIndex : Cell->Regions)
+		{
+			const FBox2D& Bounds = Regions[RegionIndex].Bounds;
+			if (Point.X >= Bounds.Min.X && Point.X <= Bounds.Max.X && Point.Y >= Bounds.Min.Y && Point.Y <= Bounds.Max.Y)
+			{
+				BestRegion = RegionIndex;
+				break;
+			}
+		}
+	}
+
+	// Unbounded ocean can still have higher priority than a bounded one
+	if (UnboundedRegions.Num() > 0)
+	{
+		const int32 Unbounded = UnboundedRegions[0];
+		if (BestRegion == INDEX_NONE || Regions[Unbounded].Priority > Regions[BestRegion].Priority)
+		{
+			BestRegion = Unbounded;
+		}
+	}
+
+	return BestRegion;
+}
+
+void FVaOceanRegistry::RebuildIndex()
+{
+	// Forget oceans that were destroyed without unregistering (level streaming, world teardown)
+	for (int32 i = Regions.Num() - 1; i >= 0; i--)
+	{
+		if (!Regions[i].OceanStateActor.IsValid())
+		{
+			Regions.RemoveAt(i);
+		}
+	}
+
+	Cells.Empty();
+	UnboundedRegions.Empty();
+
+	for (int32 RegionIndex = 0; RegionIndex < Regions.Num(); RegionIndex++)
+	{
+		const FRegion& Region = Regions[RegionIndex];
+		if (Region.bUnbounded)
+		{
+			UnboundedRegions.Add(RegionIndex);
+			continue;
+		}
+
+		const FIntPoint MinCell = GetCell(FVector(Region.Bounds.Min, 0.0f));
+		const FIntPoint MaxCell = GetCell(FVector(Region.Bounds.Max, 0.0f));
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; CellY++)
+		{
+			for (int32 CellX = MinCell.X; CellX <= MaxCell.X; CellX++)
+			{
+				FCell& Cell = Cells.FindOrAdd(FIntPoint(CellX, CellY));
+				Cell.Regions.Add(RegionIndex);
+			}
+		}
+	}
+
+	struct FSortByPriority
+	{
+		const TArray<FRegion>& Regions;
+		FSortByPriority(const TArray<FRegion>& InRegions) : Regions(InRegions) {}
+
+		bool operator()(int32 A, int32 B) const
+		{
+			return Regions[A].Priority > Regions[B].Priority;
+		}
+	};
+
+	UnboundedRegions.Sort(FSortByPriority(Regions));
+
+	for (auto It = Cells.CreateIterator(); It; ++It)
+	{
+		FCell& Cell = It.Value();
+		Cell.Regions.Sort(FSortByPriority(Regions));
+
+		// Lookup can be skipped inside the cell if its winner covers it completely
+		const FBox2D CellBounds(
+			FVector2D(It.Key().X * CellSize, It.Key().Y * CellSize),
+			FVector2D((It.Key().X + 1) * CellSize, (It.Key().Y + 1) * CellSize));
+		const FBox2D& WinnerBounds = Regions[Cell.Regions[0]].Bounds;
+
+		Cell.bUniform = WinnerBounds.IsInside(CellBounds.Min) && WinnerBounds.IsInside(CellBounds.Max);
+	}
+
+	Revision++;
+}
@@ -0,0 +1,103 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+// SSE2 is guaranteed on all desktop targets, other platforms use the scalar path
+#if PLATFORM_ENABLE_VECTORINTRINSICS && (PLATFORM_WINDOWS || PLATFORM_MAC || PLATFORM_LINUX)
+	#define VAOCEAN_SIMD_SSE 1
+	#include <emmintrin.h>
+#else
+	#define VAOCEAN_SIMD_SSE 0
+#endif
+
+/** Number of points processed at once by ocean samplers */
+#define VAOCEAN_SIMD_WIDTH 4
+
+/** Load X and Y of up to four locations into two registers (last valid location fills the unused lanes) */
+FORCEINLINE void VaVectorLoadXY(const FVector* Locations, int32 Num, VectorRegister& OutX, VectorRegister& OutY)
+{
+	const FVector& L0 = Locations[0];
+	const FVector& L1 = Locations[FMath::Min(1, Num - 1)];
+	const FVector& L2 = Locations[FMath::Min(2, Num - 1)];
+	const FVector& L3 = Locations[FMath::Min(3, Num - 1)];
+
+	OutX = MakeVectorRegister(L0.X, L1.X, L2.X, L3.X);
+	OutY = MakeVectorRegister(L0.Y, L1.Y, L2.Y, L3.Y);
+}
+
+/** Floor of four floats, both as float register and as integers */
+FORCEINLINE VectorRegister VaVectorFloor(const VectorRegister& V, int32* OutInt)
+{
+#if VAOCEAN_SIMD_SSE
+	// Truncate and step one down for negative non-integer values
+	VectorRegister Result = _mm_cvtepi32_ps(_mm_cvttps_epi32(V));
+	const VectorRegister Correction = _mm_and_ps(_mm_cmpgt_ps(Result, V), MakeVectorRegister(1.0f, 1.0f, 1.0f, 1.0f));
+	Result = VectorSubtract(Result, Correction);
+	_mm_storeu_si128((__m128i*)OutInt, _mm_cvttps_epi32(Result));
+	return Result;
+#else
+	float Values[4];
+	VectorStore(V, Values);
+	for (int32 i = 0; i < 4; i++)
+	{
+		OutInt[i] = FMath::FloorToInt(Values[i]);
+		Values[i] = (float)OutInt[i];
+	}
+	return VectorLoad(Values);
+#endif
+}
+
+/** Bilinear interpolation of four corner registers, weights should be replicated */
+FORCEINLINE VectorRegister VaVectorBilinear(const VectorRegister& C00, const VectorRegister& C10, const VectorRegister& C01, const VectorRegister& C11, const VectorRegister& FracX, const VectorRegister& FracY)
+{
+	const VectorRegister Top = VectorMultiplyAdd(VectorSubtract(C10, C00), FracX, C00);
+	const VectorRegister Bottom = VectorMultiplyAdd(VectorSubtract(C11, C01), FracX, C01);
+	return VectorMultiplyAdd(VectorSubtract(Bottom, Top), FracY, Top);
+}
+
+/** Sum of four lanes */
+FORCEINLINE float VaVectorHorizontalSum(const VectorRegister& V)
+{
+	float Values[4];
+	VectorStore(V, Values);
+	return (Values[0] + Values[1]) + (Values[2] + Values[3]);
+}
+
+/** Sine and cosine of four angles, same polynomial approach as FMath::SinCos */
+FORCEINLINE void VaVectorSinCos(const VectorRegister& Angle, VectorRegister& OutSin, VectorRegister& OutCos)
+{
+	const VectorRegister Half = VectorSetFloat1(0.5f);
+	const VectorRegister One = VectorSetFloat1(1.0f);
+	const VectorRegister HalfPi = VectorSetFloat1(HALF_PI);
+
+	// Map angle to [-pi, pi]
+	int32 Unused[4];
+	const VectorRegister Quotient = VaVectorFloor(VectorMultiplyAdd(Angle, VectorSetFloat1(1.0f / (2.0f * PI)), Half), Unused);
+	VectorRegister X = VectorSubtract(Angle, VectorMultiply(Quotient, VectorSetFloat1(2.0f * PI)));
+
+	// Map to [-pi/2, pi/2] with sin(x) = sin(pi - x), cosine changes sign there
+	const VectorRegister AbovePositive = VectorCompareGT(X, HalfPi);
+	const VectorRegister BelowNegative = VectorCompareGT(VectorNegate(HalfPi), X);
+	X = VectorSelect(AbovePositive, VectorSubtract(VectorSetFloat1(PI), X), X);
+	X = VectorSelect(BelowNegative, VectorSubtract(VectorSetFloat1(-PI), X), X);
+	const VectorRegister CosSign = VectorSelect(AbovePositive, VectorNegate(One), VectorSelect(BelowNegative, VectorNegate(One), One));
+
+	const VectorRegister X2 = VectorMultiply(X, X);
+
+	// 11-degree minimax approximation
+	VectorRegister Sin = VectorMultiplyAdd(VectorSetFloat1(-2.3889859e-08f), X2, VectorSetFloat1(2.7525562e-06f));
+	Sin = VectorMultiplyAdd(Sin, X2, VectorSetFloat1(-0.00019840874f));
+	Sin = VectorMultiplyAdd(Sin, X2, VectorSetFloat1(0.0083333310f));
+	Sin = VectorMultiplyAdd(Sin, X2, VectorSetFloat1(-0.16666667f));
+	Sin = VectorMultiplyAdd(Sin, X2, One);
+	OutSin = VectorMultiply(Sin, X);
+
+	// 10-degree minimax approximation
+	VectorRegister Cos = VectorMultiplyAdd(VectorSetFloat1(-2.6051615e-07f), X2, VectorSetFloat1(2.4760495e-05f));
+	Cos = VectorMultiplyAdd(Cos, X2, VectorSetFloat1(-0.0013888378f));
+	Cos = VectorMultiplyAdd(Cos, X2, VectorSetFloat1(0.041666638f));
+	Cos = VectorMultiplyAdd(Cos, X2, VectorNegate(Half));
+	Cos = VectorMultiplyAdd(Cos, X2, One);
+	OutCos = VectorMultiply(Cos, CosSign);
+}
+
@@ -0,0 +1,1071 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Grid sampling
+
+/** Bilinear sample of simulation grid, tiled by patch length */
+template<typename T>
+static T SampleGrid(const TArray<T>& Grid, int32 Dim, float PatchLength, const FVector& Location)
+{
+	const int32 Mask = Dim - 1;
+
+	check(Grid.Num() == Dim * Dim);
+
+	// Grid is tiled with patch length
+	const float TexelsPerUnit = Dim / PatchLength;
+	const float GridX = Location.X * TexelsPerUnit;
+	const float GridY = Location.Y * TexelsPerUnit;
+
+	const int32 X0 = FMath::FloorToInt(GridX);
+	const int32 Y0 = FMath::FloorToInt(GridY);
+	const float FracX = GridX - X0;
+	const float FracY = GridY - Y0;
+
+	// Power of two dimension lets us wrap negative coords with mask
+	const int32 PX0 = X0 & Mask;
+	const int32 PX1 = (X0 + 1) & Mask;
+	const int32 PY0 = (Y0 & Mask) * Dim;
+	const int32 PY1 = ((Y0 + 1) & Mask) * Dim;
+
+	const T Top = FMath::Lerp(Grid[PY0 + PX0], Grid[PY0 + PX1], FracX);
+	const T Bottom = FMath::Lerp(Grid[PY1 + PX0], Grid[PY1 + PX1], FracX);
+
+	return FMath::Lerp(Top, Bottom, FracY);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Spectrum helpers
+
+/** H(t) -> Dx(t), Dy(t) for desired texel of frequency domain grid */
+static void GetChoppySpectrum(const FVector2D& HtValue, int32 X, int32 Y, int32 Dim, FVector2D& OutDtx, FVector2D& OutDty)
+{
+	float Kx = X - Dim * 0.5f;
+	float Ky = Y - Dim * 0.5f;
+	const float SqrK = Kx * Kx + Ky * Ky;
+	const float RsqrK = (SqrK > 1e-12f) ? FMath::InvSqrt(SqrK) : 0.0f;
+
+	Kx *= RsqrK;
+	Ky *= RsqrK;
+
+	OutDtx = FVector2D(HtValue.Y * Kx, -HtValue.X * Kx);
+	OutDty = FVector2D(HtValue.Y * Ky, -HtValue.X * Ky);
+}
+
+/** Dx + i * Dy: transform of both real fields at once, real part is Dx and imaginary one is Dy */
+FORCEINLINE static FVector2D PackChoppySpectrum(const FVector2D& DtxValue, const FVector2D& DtyValue)
+{
+	return FVector2D(DtxValue.X - DtyValue.Y, DtxValue.Y + DtyValue.X);
+}
+
+
+/** Can one spectrum be cross-faded into another one: same wave vectors, frequencies and random numbers */
+static bool HasSameWaveVectors(const FSpectrumData& A, const FSpectrumData& B)
+{
+	if (A.DispMapDimension != B.DispMapDimension || A.PatchLength != B.PatchLength || A.TimeScale != B.TimeScale ||
+		A.RandomSeed != B.RandomSeed || A.LoopPeriod != B.LoopPeriod || A.Cascades.Num() != B.Cascades.Num() ||
+		A.PhysicsLODDimension != B.PhysicsLODDimension || A.NumPhysicsLODs != B.NumPhysicsLODs ||
+		A.bPhysicsOnlyOnDedicatedServer != B.bPhysicsOnlyOnDedicatedServer)
+	{
+		return false;
+	}
+
+	for (int32 CascadeIndex = 0; CascadeIndex < A.Cascades.Num(); CascadeIndex++)
+	{
+		if (A.Cascades[CascadeIndex].DispMapDimension != B.Cascades[CascadeIndex].DispMapDimension ||
+			A.Cascades[CascadeIndex].PatchLength != B.Cascades[CascadeIndex].PatchLength)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Async step
+
+/** Simulation step of the next frame, runs while game thread is busy with the current one */
+class FVaOceanSimulationStepTask
+{
+public:
+	FVaOceanSimulationStepTask(UVaOceanSimulatorComponent* InSimulator, float InOceanTime)
+		: Simulator(InSimulator)
+		, OceanTime(InOceanTime)
+	{
+	}
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FVaOceanSimulationStepTask, STATGROUP_TaskGraphTasks);
+	}
+
+	static ENamedThreads::Type GetDesiredThread()
+	{
+		return ENamedThreads::AnyThread;
+	}
+
+	static ESubsequentsMode::Type GetSubsequentsMode()
+	{
+		return ESubsequentsMode::TrackSubsequents;
+	}
+
+	void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+	{
+		Simulator->SimulateStep(OceanTime);
+	}
+
+private:
+	/** Simulator waits for the task before it's unregistered */
+	UVaOceanSimulatorComponent* Simulator;
+	float OceanTime;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+// Simulator component
+
+UVaOceanSimulatorComponent::UVaOceanSimulatorComponent(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	bWantsInitializeComponent = true;
+	PrimaryComponentTick.bCanEverTick = true;
+
+	bCacheSpectrumTables = true;
+	SpectrumRowsPerFrame = 32;
+	bAsyncSimulation = true;
+	bSparseSampling = false;
+	NumSparseWaves = 128;
+
+	bPendingRetarget = false;
+	PendingBlendStartTime = 0.0f;
+	PendingBlendTime = 0.0f;
+	bBlendingSpectrum = false;
+	BlendStartTime = 0.0f;
+	BlendTime = 0.0f;
+	SpectrumBlendAlpha = 0.0f;
+
+	StepTime = 0.0f;
+	SimulationTime = 0.0f;
+	NumSteps = 0;
+}
+
+void UVaOceanSimulatorComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	// Spectrum config is stored by ocean state actor
+	AVaOceanStateActor* OceanStateActor = Cast<AVaOceanStateActor>(GetOwner());
+	if (OceanStateActor)
+	{
+		InitSpectrum(OceanStateActor->GetSpectrumConfig(), true);
+	}
+	else
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Ocean simulator is not attached to ocean state actor. Default spectrum will be used."));
+		InitSpectrum(FSpectrumData(), true);
+	}
+
+	// Prepare first displacement map to be sampled right after spawn (if tables are cached already)
+	UpdateDisplacementMap(GetOceanTime());
+}
+
+void UVaOceanSimulatorComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Sparse sampling is cheaper than a task
+	if (!bAsyncSimulation || bSparseSampling || !FTaskGraphInterface::IsRunning())
+	{
+		UpdateDisplacementMap(GetOceanTime());
+		return;
+	}
+
+	// Step launched by the previous frame is usually done by now
+	FinishAsyncStep();
+
+	// Next frame is expected to be as long as this one
+	const float NextOceanTime = GetOceanTime() + DeltaTime * GetOceanTimeScale();
+	if (PrepareStep(NextOceanTime))
+	{
+		StepTime = NextOceanTime;
+		StepTask = TGraphTask<FVaOceanSimulationStepTask>::CreateTask().ConstructAndDispatchWhenReady(this, NextOceanTime);
+	}
+}
+
+void UVaOceanSimulatorComponent::OnUnregister()
+{
+	FinishAsyncStep();
+
+	Super::OnUnregister();
+}
+
+float UVaOceanSimulatorComponent::GetOceanTime() const
+{
+	// Ocean clock keeps wave phase the same on server and clients
+	const AVaOceanStateActor* OceanStateActor = Cast<AVaOceanStateActor>(GetOwner());
+	if (OceanStateActor)
+	{
+		return OceanStateActor->GetOceanTime();
+	}
+
+	return GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0f;
+}
+
+float UVaOceanSimulatorComponent::GetOceanTimeScale() const
+{
+	const AVaOceanStateActor* OceanStateActor = Cast<AVaOceanStateActor>(GetOwner());
+	if (OceanStateActor)
+	{
+		return OceanStateActor->GetOceanTimeScale();
+	}
+
+	return 1.0f;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Simulation control
+
+void UVaOceanSimulatorComponent::InitSpectrum(const FSpectrumData& InSpectrumConfig, bool bAsync)
+{
+	// Async step works with cascades
+	FinishAsyncStep();
+
+	SpectrumConfig = InSpectrumConfig;
+
+	// Pending tasks work with their own tables, so they can be just forgotten
+	SpectrumTablesTask = NULL;
+	PhysicsLODs.Empty();
+
+	bPendingRetarget = false;
+	RetargetTables.Empty();
+	RetargetTask = NULL;
+	bBlendingSpectrum = false;
+	SpectrumBlendAlpha = 0.0f;
+
+	SparseModes.Empty();
+	SparseWaveSet.Reset();
+
+	// Old config keeps working as one big patch
+	TArray<FSpectrumCascade> CascadeConfigs = SpectrumConfig.Cascades;
+	if (CascadeConfigs.Num() == 0)
+	{
+		FSpectrumCascade SinglePatch;
+		SinglePatch.DispMapDimension = SpectrumConfig.DispMapDimension;
+		SinglePatch.PatchLength = SpectrumConfig.PatchLength;
+		CascadeConfigs.Add(SinglePatch);
+	}
+	else if (CascadeConfigs.Num() > MaxCascades)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Ocean spectrum has %d cascades, only %d of them will be simulated"), CascadeConfigs.Num(), MaxCascades);
+		CascadeConfigs.SetNum(MaxCascades);
+	}
+
+	struct FSortByPatchLength
+	{
+		bool operator()(const FSpectrumCascade& A, const FSpectrumCascade& B) const
+		{
+			return A.PatchLength > B.PatchLength;
+		}
+	};
+	CascadeConfigs.Sort(FSortByPatchLength());
+
+	Cascades.Empty(CascadeConfigs.Num());
+	for (int32 CascadeIndex = 0; CascadeIndex < CascadeConfigs.Num(); CascadeIndex++)
+	{
+		FCascade& Cascade = *new(Cascades) FCascade();
+		Cascade.Dim = CascadeConfigs[CascadeIndex].DispMapDimension;
+		Cascade.PatchLength = CascadeConfigs[CascadeIndex].PatchLength;
+
+		// Cascade hands its band over to the next one where its waves get shorter than four texels
+		Cascade.MinWaveNumber = (CascadeIndex > 0) ? Cascades[CascadeIndex - 1].MaxWaveNumber : 0.0f;
+		Cascade.MaxWaveNumber = (CascadeIndex < CascadeConfigs.Num() - 1) ? PI * Cascade.Dim / (2.0f * Cascade.PatchLength) : 0.0f;
+
+		if (CascadeIndex > 0 && 2.0f * PI / Cascade.PatchLength > Cascade.MinWaveNumber)
+		{
+			UE_LOG(LogVaOcean, Warning, TEXT("Ocean cascade %d (%.0f uu) is too small for the previous one, some wave lengths will be lost"), CascadeIndex, Cascade.PatchLength);
+		}
+
+		Cascade.Tables = MakeShareable(new FVaOceanSpectrumTables());
+		InitCascadeBuffers(Cascade);
+	}
+
+	TArray<FVaOceanSpectrumTablesPtr> Tables;
+	TArray<FVaOceanSpectrumTables::FKey> Keys;
+	for (int32 CascadeIndex = 0; CascadeIndex < Cascades.Num(); CascadeIndex++)
+	{
+		Tables.Add(Cascades[CascadeIndex].Tables);
+		Keys.Add(MakeCascadeKey(SpectrumConfig, Cascades[CascadeIndex], CascadeIndex));
+	}
+
+	if (bAsync && FTaskGraphInterface::IsRunning())
+	{
+		SpectrumTablesTask = TGraphTask<FVaOceanSpectrumTablesTask>::CreateTask().ConstructAndDispatchWhenReady(Tables, Keys, bCacheSpectrumTables);
+	}
+	else
+	{
+		for (int32 CascadeIndex = 0; CascadeIndex < Tables.Num(); CascadeIndex++)
+		{
+			Tables[CascadeIndex]->LoadOrGenerate(Keys[CascadeIndex], bCacheSpectrumTables);
+		}
+
+		InitPhysicsLODs();
+	}
+
+	NumSteps = 0;
+}
+
+FVaOceanSpectrumTables::FKey UVaOceanSimulatorComponent::MakeCascadeKey(const FSpectrumData& Config, const FCascade& Cascade, int32 CascadeIndex) const
+{
+	FVaOceanSpectrumTables::FKey Key;
+	Key.Dim = Cascade.Dim;
+	Key.PatchLength = Cascade.PatchLength;
+
+	// Mode amplitude is proportional to the wave number step, so all cascades share the same spectrum
+	Key.Amplitude = VaOceanPhillipsAmplitude(Config) * FMath::Square(Config.PatchLength / Cascade.PatchLength);
+
+	Key.MinWaveNumber = Cascade.MinWaveNumber;
+	Key.MaxWaveNumber = Cascade.MaxWaveNumber;
+
+	const FVector2D WindDir = Config.WindDirection.SafeNormal();
+	Key.WindDirectionX = WindDir.X;
+	Key.WindDirectionY = WindDir.Y;
+	Key.WindSpeed = Config.WindSpeed;
+	Key.WindDependency = Config.WindDependency;
+
+	// Looping animation needs all frequencies to be multiples of the base one
+	Key.LoopOmega = (Config.LoopPeriod > KINDA_SMALL_NUMBER) ? 2.0f * PI / (Config.LoopPeriod * Config.TimeScale) : 0.0f;
+
+	// Each cascade has its own random sequence
+	Key.RandomSeed = Config.RandomSeed + CascadeIndex;
+
+	return Key;
+}
+
+void UVaOceanSimulatorComponent::InitPhysicsLODs()
+{
+	PhysicsLODs.Empty();
+
+	// Sparse sampling takes waves from full resolution tables
+	if (SpectrumConfig.PhysicsLODDimension <= 0 || Cascades.Num() == 0 || bSparseSampling)
+	{
+		return;
+	}
+
+	// The first LOD is defined by the longest cascade, so it has the same look on any cascade setup
+	float MinWaveLength = 2.0f * Cascades[0].PatchLength / FMath::RoundUpToPowerOfTwo(SpectrumConfig.PhysicsLODDimension);
+
+	for (int32 LODIndex = 0; LODIndex < SpectrumConfig.NumPhysicsLODs; LODIndex++, MinWaveLength *= 2.0f)
+	{
+		FPhysicsLOD& PhysicsLOD = *new(PhysicsLODs) FPhysicsLOD();
+		PhysicsLOD.MinWaveLength = MinWaveLength;
+
+		for (int32 CascadeIndex = 0; CascadeIndex < Cascades.Num(); CascadeIndex++)
+		{
+			const FCascade& Source = Cascades[CascadeIndex];
+
+			// Cascades are sorted, so the rest of them have even shorter waves
+			if (Source.MinWaveNumber > 0.0f && 2.0f * PI / Source.MinWaveNumber < MinWaveLength)
+			{
+				break;
+			}
+
+			FCascade& Cascade = *new(PhysicsLOD.Cascades) FCascade();
+
+			// Grid should have two texels per the shortest wave
+			const int32 Dim = FMath::Max(4, (int32)FMath::RoundUpToPowerOfTwo(FMath::CeilToInt(2.0f * Source.PatchLength / MinWaveLength)));
+			if (Dim >= Source.Dim)
+			{
+				Cascade.SharedCascade = CascadeIndex;
+			}
+			else
+			{
+				InitBandLimitedCascade(Cascade, Source, Dim);
+			}
+		}
+	}
+
+	// Dedicated server has no one to show full resolution cascades
+	if (SpectrumConfig.bPhysicsOnlyOnDedicatedServer && IsRunningDedicatedServer())
+	{
+		for (FCascade& Cascade : Cascades)
+		{
+			Cascade.bSkipSimulation = true;
+		}
+
+		for (const FPhysicsLOD& PhysicsLOD : PhysicsLODs)
+		{
+			for (const FCascade& Cascade : PhysicsLOD.Cascades)
+			{
+				if (Cascade.SharedCascade != INDEX_NONE)
+				{
+					Cascades[Cascade.SharedCascade].bSkipSimulation = false;
+				}
+			}
+		}
+	}
+}
+
+void UVaOceanSimulatorComponent::InitCascadeBuffers(FCascade& Cascade)
+{
+	check(FMath::IsPowerOfTwo(Cascade.Dim));
+
+	// Twiddle tables for inverse FFT of Dim size
+	Cascade.FFT.Init(Cascade.Dim);
+
+	const int32 OutputSize = Cascade.Dim * Cascade.Dim;
+	Cascade.Ht.Init(FVector2D::ZeroVector, OutputSize);
+	Cascade.Dxy.Init(FVector2D::ZeroVector, OutputSize);
+}
+
+void UVaOceanSimulatorComponent::InitBandLimitedCascade(FCascade& Cascade, const FCascade& Source, int32 Dim)
+{
+	Cascade.Dim = Dim;
+	Cascade.PatchLength = Source.PatchLength;
+	Cascade.MinWaveNumber = Source.MinWaveNumber;
+	Cascade.MaxWaveNumber = PI * Dim / Source.PatchLength;
+
+	Cascade.Tables = MakeShareable(new FVaOceanSpectrumTables());
+	Cascade.Tables->InitBandLimited(*Source.Tables, Dim);
+
+	InitCascadeBuffers(Cascade);
+}
+
+void UVaOceanSimulatorComponent::RetargetSpectrum(const FSpectrumData& InSpectrumConfig, float InBlendStartTime, float InBlendTime)
+{
+	// There is nothing to blend from yet
+	if (Cascades.Num() == 0 || SpectrumTablesTask.IsValid())
+	{
+		InitSpectrum(InSpectrumConfig, true);
+		return;
+	}
+
+	if (!HasSameWaveVectors(SpectrumConfig, InSpectrumConfig))
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Ocean spectrum can't be cross-faded into one with other cascades, seed or time scale. Simulation is restarted."));
+		InitSpectrum(InSpectrumConfig, true);
+		return;
+	}
+
+	// Only the latest request matters, the one in progress will be finished first
+	bPendingRetarget = true;
+	PendingSpectrumConfig = InSpectrumConfig;
+	PendingBlendStartTime = InBlendStartTime;
+	PendingBlendTime = InBlendTime;
+}
+
+void UVaOceanSimulatorComponent::UpdateSpectrumRetarget(float OceanTime)
+{
+	// Target tables are generated a few rows per frame
+	if (RetargetTables.Num() > 0)
+	{
+		if (RetargetTask.IsValid())
+		{
+			if (!RetargetTask->IsComplete())
+			{
+				return;
+			}
+
+			RetargetTask = NULL;
+		}
+
+		bool bGenerated = true;
+		for (const FVaOceanSpectrumTablesPtr& Tables : RetargetTables)
+		{
+			bGenerated = bGenerated && Tables->IsValid();
+		}
+
+		if (!bGenerated)
+		{
+			if (FTaskGraphInterface::IsRunning())
+			{
+				RetargetTask = TGraphTask<FVaOceanSpectrumRowsTask>::CreateTask().ConstructAndDispatchWhenReady(RetargetTables, SpectrumRowsPerFrame);
+			}
+			else
+			{
+				for (const FVaOceanSpectrumTablesPtr& Tables : RetargetTables)
+				{
+					Tables->GenerateRows(SpectrumRowsPerFrame);
+				}
+			}
+
+			return;
+		}
+
+		for (int32 CascadeIndex = 0; CascadeIndex < Cascades.Num(); CascadeIndex++)
+		{
+			Cascades[CascadeIndex].TargetTables = RetargetTables[CascadeIndex];
+		}
+
+		// Physics LOD cascades are made in the same order as full resolution ones
+		for (FPhysicsLOD& PhysicsLOD : PhysicsLODs)
+		{
+			for (int32 CascadeIndex = 0; CascadeIndex < PhysicsLOD.Cascades.Num(); CascadeIndex++)
+			{
+				FCascade& Cascade = PhysicsLOD.Cascades[CascadeIndex];
+				if (Cascade.SharedCascade == INDEX_NONE)
+				{
+					Cascade.TargetTables = MakeShareable(new FVaOceanSpectrumTables());
+					Cascade.TargetTables->InitBandLimited(*Cascades[CascadeIndex].TargetTables, Cascade.Dim);
+				}
+			}
+		}
+
+		RetargetTables.Empty();
+		bBlendingSpectrum = true;
+
+		// Waves that become strong with new spectrum should be sampled too
+		SparseModes.Empty();
+	}
+
+	if (bBlendingSpectrum)
+	{
+		// Blend is timed with ocean clock, so all machines show the same sea state
+		SpectrumBlendAlpha = (BlendTime > KINDA_SMALL_NUMBER) ? FMath::Clamp((OceanTime - BlendStartTime) / BlendTime, 0.0f, 1.0f) : 1.0f;
+		if (SpectrumBlendAlpha < 1.0f)
+		{
+			return;
+		}
+
+		// Target is fully faded in, so it becomes the current spectrum
+		for (FCascade& Cascade : Cascades)
+		{
+			Cascade.Tables = Cascade.TargetTables;
+			Cascade.TargetTables.Reset();
+		}
+
+		for (FPhysicsLOD& PhysicsLOD : PhysicsLODs)
+		{
+			for (FCascade& Cascade : PhysicsLOD.Cascades)
+			{
+				if (Cascade.TargetTables.IsValid())
+				{
+					Cascade.Tables = Cascade.TargetTables;
+					Cascade.TargetTables.Reset();
+				}
+			}
+		}
+
+		SpectrumConfig = TargetSpectrumConfig;
+		bBlendingSpectrum = false;
+		SpectrumBlendAlpha = 0.0f;
+
+		SparseModes.Empty();
+		SparseWaveSet.Reset();
+	}
+
+	if (bPendingRetarget)
+	{
+		bPendingRetarget = false;
+		TargetSpectrumConfig = PendingSpectrumConfig;
+		BlendStartTime = PendingBlendStartTime;
+		BlendTime = PendingBlendTime;
+
+		// Same seed gives the same random numbers, so only amplitudes of the waves are changed
+		RetargetTables.Empty(Cascades.Num());
+		for (int32 CascadeIndex = 0; CascadeIndex < Cascades.Num(); CascadeIndex++)
+		{
+			FVaOceanSpectrumTablesPtr Tables = MakeShareable(new FVaOceanSpectrumTables());
+			Tables->BeginGenerate(MakeCascadeKey(TargetSpectrumConfig, Cascades[CascadeIndex], CascadeIndex));
+			RetargetTables.Add(Tables);
+		}
+	}
+}
+
+void UVaOceanSimulatorComponent::UpdateDisplacementMap(float OceanTime)
+{
+	FinishAsyncStep();
+
+	if (!PrepareStep(OceanTime))
+	{
+		return;
+	}
+
+	if (bSparseSampling)
+	{
+		// Waves are evaluated by sampler, so the set is changed only with spectrum
+		if (SparseModes.Num() == 0)
+		{
+			SelectSparseModes();
+		}
+
+		if (!SparseWaveSet.IsValid() || bBlendingSpectrum)
+		{
+			UpdateSparseWaveSet();
+		}
+
+		return;
+	}
+
+	SimulateStep(OceanTime);
+	PublishStep(OceanTime);
+}
+
+bool UVaOceanSimulatorComponent::PrepareStep(float OceanTime)
+{
+	if (Cascades.Num() == 0)
+	{
+		return false;
+	}
+
+	// Wait for spectrum tables without blocking the game thread
+	if (SpectrumTablesTask.IsValid())
+	{
+		if (!SpectrumTablesTask->IsComplete())
+		{
+			return false;
+		}
+
+		SpectrumTablesTask = NULL;
+		InitPhysicsLODs();
+	}
+
+	UpdateSpectrumRetarget(OceanTime);
+
+	return true;
+}
+
+void UVaOceanSimulatorComponent::SimulateStep(float OceanTime)
+{
+	for (FCascade& Cascade : Cascades)
+	{
+		if (!Cascade.bSkipSimulation)
+		{
+			UpdateCascade(Cascade, OceanTime);
+		}
+	}
+
+	// Physics LODs are small, so they cost a fraction of the full resolution step
+	for (FPhysicsLOD& PhysicsLOD : PhysicsLODs)
+	{
+		for (FCascade& Cascade : PhysicsLOD.Cascades)
+		{
+			if (Cascade.SharedCascade == INDEX_NONE)
+			{
+				UpdateCascade(Cascade, OceanTime);
+			}
+		}
+	}
+}
+
+void UVaOceanSimulatorComponent::PublishStep(float OceanTime)
+{
+	struct FLocal
+	{
+		static void Publish(FCascade& Cascade)
+		{
+			// Previous grid becomes spare
+			if (Cascade.StepGrid.IsValid())
+			{
+				Cascade.SpareGrid = Cascade.DisplacementGrid;
+				Cascade.DisplacementGrid = Cascade.StepGrid;
+				Cascade.StepGrid.Reset();
+			}
+		}
+	};
+
+	for (FCascade& Cascade : Cascades)
+	{
+		FLocal::Publish(Cascade);
+	}
+
+	for (FPhysicsLOD& PhysicsLOD : PhysicsLODs)
+	{
+		for (FCascade& Cascade : PhysicsLOD.Cascades)
+		{
+			FLocal::Publish(Cascade);
+		}
+	}
+
+	SimulationTime = OceanTime;
+	NumSteps++;
+}
+
+void UVaOceanSimulatorComponent::FinishAsyncStep()
+{
+	if (StepTask.IsValid())
+	{
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(StepTask);
+		StepTask = NULL;
+
+		PublishStep(StepTime);
+	}
+}
+
+void UVaOceanSimulatorComponent::SelectSparseModes()
+{
+	struct FCandidate
+	{
+		float Energy;
+		FSparseMode Mode;
+	};
+
+	TArray<FCandidate> Candidates;
+	for (int32 CascadeIndex = 0; CascadeIndex < Cascades.Num(); CascadeIndex++)
+	{
+		const FCascade& Cascade = Cascades[CascadeIndex];
+		const int32 Dim = Cascade.Dim;
+		const int32 InWidth = Dim + 4;
+
+		const FVector2D* H0 = Cascade.Tables->GetH0();
+		const FVector2D* TargetH0 = Cascade.TargetTables.IsValid() ? Cascade.TargetTables->GetH0() : NULL;
+
+		// Modes of FFT grid, cascade bands don't overlap so each wave is met once
+		for (int32 Y = 0; Y < Dim; Y++)
+		{
+			for (int32 X = 0; X < Dim; X++)
+			{
+				const int32 Index = Y * InWidth + X;
+
+				float Energy = H0[Index].SizeSquared();
+				if (TargetH0)
+				{
+					Energy = FMath::Max(Energy, TargetH0[Index].SizeSquared());
+				}
+
+				if (Energy > 0.0f)
+				{
+					FCandidate& Candidate = *new(Candidates) FCandidate();
+					Candidate.Energy = Energy;
+					Candidate.Mode.CascadeIndex = CascadeIndex;
+					Candidate.Mode.Index = Index;
+				}
+			}
+		}
+	}
+
+	struct FSortByEnergy
+	{
+		bool operator()(const FCandidate& A, const FCandidate& B) const
+		{
+			return A.Energy > B.Energy;
+		}
+	};
+	Candidates.Sort(FSortByEnergy());
+
+	const int32 NumModes = FMath::Min(NumSparseWaves, Candidates.Num());
+	SparseModes.Empty(NumModes);
+	for (int32 ModeIndex = 0; ModeIndex < NumModes; ModeIndex++)
+	{
+		SparseModes.Add(Candidates[ModeIndex].Mode);
+	}
+}
+
+void UVaOceanSimulatorComponent::UpdateSparseWaveSet()
+{
+	TArray<FVaOceanSpectralWave> Waves;
+	Waves.Empty(SparseModes.Num());
+
+	for (const FSparseMode& Mode : SparseModes)
+	{
+		const FCascade& Cascade = Cascades[Mode.CascadeIndex];
+		const int32 InWidth = Cascade.Dim + 4;
+
+		FVector2D H0k = Cascade.Tables->GetH0()[Mode.Index];
+		if (Cascade.TargetTables.IsValid())
+		{
+			H0k = FMath::Lerp(H0k, Cascade.TargetTables->GetH0()[Mode.Index], SpectrumBlendAlpha);
+		}
+
+		// Grid sum of h0(k) * exp(i * (k * x + w * t)) and its conjugate pair gives 2 * |h0| wave
+		FVaOceanSpectralWave& Wave = *new(Waves) FVaOceanSpectralWave();
+		Wave.K.X = (Mode.Index % InWidth - Cascade.Dim / 2) * (2.0f * PI / Cascade.PatchLength);
+		Wave.K.Y = (Mode.Index / InWidth - Cascade.Dim / 2) * (2.0f * PI / Cascade.PatchLength);
+		Wave.Omega = Cascade.Tables->GetOmega()[Mode.Index] * SpectrumConfig.TimeScale;
+		Wave.Phase = FMath::Atan2(H0k.Y, H0k.X);
+		Wave.Amplitude = 2.0f * H0k.Size();
+	}
+
+	// Flat displacement needs no inverse lookup
+	const int32 InverseIterations = (SpectrumConfig.ChoppyScale > 0.0f) ? FMath::Clamp(SpectrumConfig.InverseDisplacementIterations, 0, 4) : 0;
+
+	// Snapshots can still reference the old set, so new one is created each time
+	FVaOceanWaveSet* NewWaveSet = new FVaOceanWaveSet();
+	NewWaveSet->InitSpectral(Waves, SpectrumConfig.ChoppyScale, InverseIterations);
+
+	SparseWaveSet = MakeShareable(NewWaveSet);
+}
+
+void UVaOceanSimulatorComponent::UpdateCascade(FCascade& Cascade, float OceanTime)
+{
+	const int32 Dim = Cascade.Dim;
+	const int32 InWidth = Dim + 4;
+
+	const FVector2D* H0 = Cascade.Tables->GetH0();
+	const float* Omega = Cascade.Tables->GetOmega();
+
+	// Target spectrum has the same frequencies, so H(0) is all that should be cross-faded
+	const FVector2D* TargetH0 = (Cascade.TargetTables.IsValid() && SpectrumBlendAlpha > 0.0f) ? Cascade.TargetTables->GetH0() : NULL;
+	const float BlendAlpha = SpectrumBlendAlpha;
+	TArray<FVector2D>& Ht = Cascade.Ht;
+	TArray<FVector2D>& Dxy = Cascade.Dxy;
+
+	const float Time = OceanTime * SpectrumConfig.TimeScale;
+
+	//
+	// H(0) -> H(t), Dx(t), Dy(t) [UpdateSpectrumCS]
+	//
+
+	for (int32 Y = 0; Y < Dim; Y++)
+	{
+		for (int32 X = 0; X < Dim; X++)
+		{
+			const int32 InIndex = Y * InWidth + X;
+			const int32 InMIndex = (Dim - Y) * InWidth + (Dim - X);
+			const int32 OutIndex = Y * Dim + X;
+
+			// H(0) -> H(t)
+			FVector2D H0k = H0[InIndex];
+			FVector2D H0mk = H0[InMIndex];
+			if (TargetH0)
+			{
+				H0k = FMath::Lerp(H0k, TargetH0[InIndex], BlendAlpha);
+				H0mk = FMath::Lerp(H0mk, TargetH0[InMIndex], BlendAlpha);
+			}
+
+			float SinV, CosV;
+			FMath::SinCos(&SinV, &CosV, Omega[InIndex] * Time);
+
+			FVector2D HtValue;
+			HtValue.X = (H0k.X + H0mk.X) * CosV - (H0k.Y + H0mk.Y) * SinV;
+			HtValue.Y = (H0k.X - H0mk.X) * SinV + (H0k.Y - H0mk.Y) * CosV;
+
+			// H(t) -> Dx(t), Dy(t)
+			FVector2D DtxValue, DtyValue;
+			GetChoppySpectrum(HtValue, X, Y, Dim, DtxValue, DtyValue);
+
+			Ht[OutIndex] = HtValue;
+			Dxy[OutIndex] = PackChoppySpectrum(DtxValue, DtyValue);
+		}
+	}
+
+	// Dx and Dy are Hermitian everywhere except the first row and column: their -k pairs are
+	// outside of the grid. Only Hermitian part of these texels gets into the real output, so pack just it.
+	const int32 Mask = Dim - 1;
+	for (int32 Y = 0; Y < Dim; Y++)
+	{
+		for (int32 X = 0; X < Dim; X += (Y == 0) ? 1 : Dim)
+		{
+			const int32 MX = (Dim - X) & Mask;
+			const int32 MY = (Dim - Y) & Mask;
+
+			FVector2D DtxValue, DtyValue, DtxMirror, DtyMirror;
+			GetChoppySpectrum(Ht[Y * Dim + X], X, Y, Dim, DtxValue, DtyValue);
+			GetChoppySpectrum(Ht[MY * Dim + MX], MX, MY, Dim, DtxMirror, DtyMirror);
+
+			Dxy[Y * Dim + X] = PackChoppySpectrum(
+				FVector2D(DtxValue.X + DtxMirror.X, DtxValue.Y - DtxMirror.Y) * 0.5f,
+				FVector2D(DtyValue.X + DtyMirror.X, DtyValue.Y - DtyMirror.Y) * 0.5f);
+		}
+	}
+
+	//
+	// Inverse FFT [VaOcean_FFT.usf]
+	//
+
+	FVector2D* const Grids[] = { Ht.GetTypedData(), Dxy.GetTypedData() };
+	Cascade.FFT.Inverse2D(Grids, ARRAY_COUNT(Grids));
+
+	//
+	// Grid for results: reuse the spare one if no snapshot holds it anymore
+	//
+
+	TSharedPtr<FVaOceanGrid, ESPMode::ThreadSafe> Grid;
+	if (Cascade.SpareGrid.IsValid() && Cascade.SpareGrid.IsUnique())
+	{
+		Grid = Cascade.SpareGrid;
+	}
+	else
+	{
+		Grid = MakeShareable(new FVaOceanGrid());
+		Grid->Init(Dim, Dim, Cascade.PatchLength, Cascade.PatchLength);
+		Grid->Displacements.AddUninitialized(Dim * Dim);
+		Grid->Gradients.AddUninitialized(Dim * Dim);
+		Grid->Velocities.AddUninitialized(Dim * Dim);
+	}
+	Cascade.SpareGrid.Reset();
+
+	//
+	// Dx, Dy, Dz -> Displacement [UpdateDisplacementPS]
+	//
+
+	FVector* DisplacementData = Grid->Displacements.GetTypedData();
+
+	const float ChoppyScale = SpectrumConfig.ChoppyScale;
+	for (int32 Y = 0; Y < Dim; Y++)
+	{
+		for (int32 X = 0; X < Dim; X++)
+		{
+			const int32 Index = Y * Dim + X;
+
+			// cos(pi * (m1 + m2))
+			const float SignCorrection = ((X + Y) & 1) ? -1.0f : 1.0f;
+
+			DisplacementData[Index] = FVector(
+				Dxy[Index].X * SignCorrection * ChoppyScale,
+				Dxy[Index].Y * SignCorrection * ChoppyScale,
+				Ht[Index].X * SignCorrection);
+		}
+	}
+
+	//
+	// Displacement -> Gradient [GenGradientFoldingPS]
+	//
+
+	FVector2D* GradientData = Grid->Gradients.GetTypedData();
+
+	const float InvDoubleTexelSize = Dim / (2.0f * Cascade.PatchLength);
+	for (int32 Y = 0; Y < Dim; Y++)
+	{
+		const int32 Back = ((Y - 1) & Mask) * Dim;
+		const int32 Front = ((Y + 1) & Mask) * Dim;
+
+		for (int32 X = 0; X < Dim; X++)
+		{
+			const int32 Left = (X - 1) & Mask;
+			const int32 Right = (X + 1) & Mask;
+
+			GradientData[Y * Dim + X] = FVector2D(
+				(DisplacementData[Y * Dim + Right].Z - DisplacementData[Y * Dim + Left].Z) * InvDoubleTexelSize,
+				(DisplacementData[Front + X].Z - DisplacementData[Back + X].Z) * InvDoubleTexelSize);
+		}
+	}
+
+	//
+	// Displacement change rate from the previous step
+	//
+
+	FVector* VelocityData = Grid->Velocities.GetTypedData();
+
+	const float DeltaTime = OceanTime - SimulationTime;
+	if (Cascade.DisplacementGrid.IsValid() && DeltaTime > KINDA_SMALL_NUMBER)
+	{
+		const FVector* PrevDisplacementData = Cascade.DisplacementGrid->Displacements.GetTypedData();
+		const float InvDeltaTime = 1.0f / DeltaTime;
+
+		for (int32 Index = 0; Index < Dim * Dim; Index++)
+		{
+			VelocityData[Index] = (DisplacementData[Index] - PrevDisplacementData[Index]) * InvDeltaTime;
+		}
+	}
+	else
+	{
+		FMemory::Memzero(VelocityData, Dim * Dim * sizeof(FVector));
+	}
+
+	// Game thread publishes it with the rest of the step
+	Cascade.StepGrid = Grid;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Displacement grid access
+
+bool UVaOceanSimulatorComponent::IsSimulationReady() const
+{
+	return NumSteps > 0 && Cascades.Num() > 0 && !bSparseSampling;
+}
+
+FVector UVaOceanSimulatorComponent::GetDisplacementAtLocation(const FVector& Location) const
+{
+	if (!IsSimulationReady())
+	{
+		return FVector::ZeroVector;
+	}
+
+	FVector Displacement = FVector::ZeroVector;
+	for (const FCascade& Cascade : Cascades)
+	{
+		if (!Cascade.DisplacementGrid.IsValid())
+		{
+			continue;
+		}
+
+		Displacement += SampleGrid(Cascade.DisplacementGrid->Displacements, Cascade.Dim, Cascade.PatchLength, Location);
+	}
+
+	return Displacement;
+}
+
+int32 UVaOceanSimulatorComponent::GetNumCascades() const
+{
+	return Cascades.Num();
+}
+
+FVaOceanGridPtr UVaOceanSimulatorComponent::GetDisplacementGrid(int32 CascadeIndex) const
+{
+	if (!Cascades.IsValidIndex(CascadeIndex))
+	{
+		return FVaOceanGridPtr();
+	}
+
+	return Cascades[CascadeIndex].DisplacementGrid;
+}
+
+int32 UVaOceanSimulatorComponent::GetNumPhysicsLODs() const
+{
+	return PhysicsLODs.Num();
+}
+
+float UVaOceanSimulatorComponent::GetPhysicsLODWaveLength(int32 PhysicsLOD) const
+{
+	return PhysicsLODs.IsValidIndex(PhysicsLOD) ? PhysicsLODs[PhysicsLOD].MinWaveLength : 0.0f;
+}
+
+void UVaOceanSimulatorComponent::GetCascadeGrids(int32 PhysicsLOD, TArray<FVaOceanGridPtr>& OutGrids) const
+{
+	OutGrids.Reset();
+
+	// Physics-only simulation answers full resolution queries with the finest LOD
+	if (PhysicsLOD == INDEX_NONE && PhysicsLODs.Num() > 0)
+	{
+		for (const FCascade& Cascade : Cascades)
+		{
+			if (Cascade.bSkipSimulation)
+			{
+				PhysicsLOD = 0;
+				break;
+			}
+		}
+	}
+
+	if (!PhysicsLODs.IsValidIndex(PhysicsLOD))
+	{
+		for (const FCascade& Cascade : Cascades)
+		{
+			if (Cascade.DisplacementGrid.IsValid())
+			{
+				OutGrids.Add(Cascade.DisplacementGrid);
+			}
+		}
+		return;
+	}
+
+	for (const FCascade& Cascade : PhysicsLODs[PhysicsLOD].Cascades)
+	{
+		const FCascade& Simulated = (Cascade.SharedCascade != INDEX_NONE) ? Cascades[Cascade.SharedCascade] : Cascade;
+		if (Simulated.DisplacementGrid.IsValid())
+		{
+			OutGrids.Add(Simulated.DisplacementGrid);
+		}
+	}
+}
+
+FVaOceanWaveSetPtr UVaOceanSimulatorComponent::GetSparseWaveSet() const
+{
+	return bSparseSampling ? SparseWaveSet : FVaOceanWaveSetPtr();
+}
+
+float UVaOceanSimulatorComponent::GetSimulationTime() const
+{
+	return SimulationTime;
+}
+
+const FSpectrumData& UVaOceanSimulatorComponent::GetSpectrumConfig() const
+{
+	return SpectrumConfig;
+}
@@ -0,0 +1,800 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanGrid
+
+FVaOceanGrid::FVaOceanGrid()
+	: SizeX(0)
+	, SizeY(0)
+	, TexelsPerUnitX(0.0f)
+	, TexelsPerUnitY(0.0f)
+	, HeightBytesScale(1.0f)
+	, HeightBytesBias(0.0f)
+	, MeanHeight(0.0f)
+{
+}
+
+void FVaOceanGrid::Init(int32 InSizeX, int32 InSizeY, float WorldSizeX, float WorldSizeY)
+{
+	check(FMath::IsPowerOfTwo(InSizeX) && FMath::IsPowerOfTwo(InSizeY));
+
+	SizeX = InSizeX;
+	SizeY = InSizeY;
+	TexelsPerUnitX = SizeX / WorldSizeX;
+	TexelsPerUnitY = SizeY / WorldSizeY;
+}
+
+void FVaOceanGrid::Sample(float TexelX, float TexelY, float& OutHeight, FVector2D& OutGradient, FVector& OutVelocity) const
+{
+	const int32 X0 = FMath::FloorToInt(TexelX);
+	const int32 Y0 = FMath::FloorToInt(TexelY);
+	const float FracX = TexelX - X0;
+	const float FracY = TexelY - Y0;
+
+	// Dimensions are power of two, so mask wraps negative coords too
+	const int32 MaskX = SizeX - 1;
+	const int32 MaskY = SizeY - 1;
+	const int32 PX0 = X0 & MaskX;
+	const int32 PX1 = (X0 + 1) & MaskX;
+	const int32 PY0 = (Y0 & MaskY) * SizeX;
+	const int32 PY1 = ((Y0 + 1) & MaskY) * SizeX;
+
+	const float H00 = GetHeight(PY0 + PX0);
+	const float H10 = GetHeight(PY0 + PX1);
+	const float H01 = GetHeight(PY1 + PX0);
+	const float H11 = GetHeight(PY1 + PX1);
+
+	const float Top = FMath::Lerp(H00, H10, FracX);
+	const float Bottom = FMath::Lerp(H01, H11, FracX);
+	OutHeight = FMath::Lerp(Top, Bottom, FracY);
+
+	if (Gradients.Num() > 0)
+	{
+		const FVector2D GradientTop = FMath::Lerp(Gradients[PY0 + PX0], Gradients[PY0 + PX1], FracX);
+		const FVector2D GradientBottom = FMath::Lerp(Gradients[PY1 + PX0], Gradients[PY1 + PX1], FracX);
+		OutGradient = FMath::Lerp(GradientTop, GradientBottom, FracY);
+	}
+	else if (HeightBytes.Num() > 0)
+	{
+		const FVector2D GradientTop = FMath::Lerp(GetCentralGradient(X0, Y0), GetCentralGradient(X0 + 1, Y0), FracX);
+		const FVector2D GradientBottom = FMath::Lerp(GetCentralGradient(X0, Y0 + 1), GetCentralGradient(X0 + 1, Y0 + 1), FracX);
+		OutGradient = FMath::Lerp(GradientTop, GradientBottom, FracY);
+	}
+	else
+	{
+		// Derivatives of bilinear patch
+		OutGradient.X = FMath::Lerp(H10 - H00, H11 - H01, FracY) * TexelsPerUnitX;
+		OutGradient.Y = (Bottom - Top) * TexelsPerUnitY;
+	}
+
+	if (Velocities.Num() > 0)
+	{
+		const FVector VelocityTop = FMath::Lerp(Velocities[PY0 + PX0], Velocities[PY0 + PX1], FracX);
+		const FVector VelocityBottom = FMath::Lerp(Velocities[PY1 + PX0], Velocities[PY1 + PX1], FracX);
+		OutVelocity = FMath::Lerp(VelocityTop, VelocityBottom, FracY);
+	}
+	else
+	{
+		OutVelocity = FVector::ZeroVector;
+	}
+}
+
+FVector2D FVaOceanGrid::SampleHorizontal(float TexelX, float TexelY) const
+{
+	if (Displacements.Num() == 0)
+	{
+		return FVector2D::ZeroVector;
+	}
+
+	const int32 X0 = FMath::FloorToInt(TexelX);
+	const int32 Y0 = FMath::FloorToInt(TexelY);
+	const float FracX = TexelX - X0;
+	const float FracY = TexelY - Y0;
+
+	const int32 MaskX = SizeX - 1;
+	const int32 MaskY = SizeY - 1;
+	const int32 PX0 = X0 & MaskX;
+	const int32 PX1 = (X0 + 1) & MaskX;
+	const int32 PY0 = (Y0 & MaskY) * SizeX;
+	const int32 PY1 = ((Y0 + 1) & MaskY) * SizeX;
+
+	const FVector Top = FMath::Lerp(Displacements[PY0 + PX0], Displacements[PY0 + PX1], FracX);
+	const FVector Bottom = FMath::Lerp(Displacements[PY1 + PX0], Displacements[PY1 + PX1], FracX);
+	const FVector Displacement = FMath::Lerp(Top, Bottom, FracY);
+
+	return FVector2D(Displacement.X, Displacement.Y);
+}
+
+void FVaOceanGrid::SampleHorizontal4(const VectorRegister& TexelX, const VectorRegister& TexelY, VectorRegister& OutDx, VectorRegister& OutDy) const
+{
+	if (Displacements.Num() == 0)
+	{
+		OutDx = VectorSetFloat1(0.0f);
+		OutDy = VectorSetFloat1(0.0f);
+		return;
+	}
+
+	int32 X0[VAOCEAN_SIMD_WIDTH], Y0[VAOCEAN_SIMD_WIDTH];
+	const VectorRegister FracX = VectorSubtract(TexelX, VaVectorFloor(TexelX, X0));
+	const VectorRegister FracY = VectorSubtract(TexelY, VaVectorFloor(TexelY, Y0));
+
+	// Gather corners lane by lane, filter all lanes at once
+	float Dx00[VAOCEAN_SIMD_WIDTH], Dx10[VAOCEAN_SIMD_WIDTH], Dx01[VAOCEAN_SIMD_WIDTH], Dx11[VAOCEAN_SIMD_WIDTH];
+	float Dy00[VAOCEAN_SIMD_WIDTH], Dy10[VAOCEAN_SIMD_WIDTH], Dy01[VAOCEAN_SIMD_WIDTH], Dy11[VAOCEAN_SIMD_WIDTH];
+
+	const int32 MaskX = SizeX - 1;
+	const int32 MaskY = SizeY - 1;
+	for (int32 Lane = 0; Lane < VAOCEAN_SIMD_WIDTH; Lane++)
+	{
+		const int32 PX0 = X0[Lane] & MaskX;
+		const int32 PX1 = (X0[Lane] + 1) & MaskX;
+		const int32 PY0 = (Y0[Lane] & MaskY) * SizeX;
+		const int32 PY1 = ((Y0[Lane] + 1) & MaskY) * SizeX;
+
+		const FVector& D00 = Displacements[PY0 + PX0];
+		const FVector& D10 = Displacements[PY0 + PX1];
+		const FVector& D01 = Displacements[PY1 + PX0];
+		const FVector& D11 = Displacements[PY1 + PX1];
+
+		Dx00[Lane] = D00.X; Dy00[Lane] = D00.Y;
+		Dx10[Lane] = D10.X; Dy10[Lane] = D10.Y;
+		Dx01[Lane] = D01.X; Dy01[Lane] = D01.Y;
+		Dx11[Lane] = D11.X; Dy11[Lane] = D11.Y;
+	}
+
+	OutDx = VaVectorBilinear(VectorLoad(Dx00), VectorLoad(Dx10), VectorLoad(Dx01), VectorLoad(Dx11), FracX, FracY);
+	OutDy = VaVectorBilinear(VectorLoad(Dy00), VectorLoad(Dy10), VectorLoad(Dy01), VectorLoad(Dy11), FracX, FracY);
+}
+
+void FVaOceanGrid::Sample4(const VectorRegister& TexelX, const VectorRegister& TexelY, int32 NumLanes, float* OutHeights, FVector2D* OutGradients, FVector* OutVelocities) const
+{
+	int32 X0[VAOCEAN_SIMD_WIDTH], Y0[VAOCEAN_SIMD_WIDTH];
+	const VectorRegister FracX = VectorSubtract(TexelX, VaVectorFloor(TexelX, X0));
+	const VectorRegister FracY = VectorSubtract(TexelY, VaVectorFloor(TexelY, Y0));
+
+	// Gather four corners for each lane
+	int32 I00[VAOCEAN_SIMD_WIDTH], I10[VAOCEAN_SIMD_WIDTH], I01[VAOCEAN_SIMD_WIDTH], I11[VAOCEAN_SIMD_WIDTH];
+	float H00[VAOCEAN_SIMD_WIDTH], H10[VAOCEAN_SIMD_WIDTH], H01[VAOCEAN_SIMD_WIDTH], H11[VAOCEAN_SIMD_WIDTH];
+
+	const int32 MaskX = SizeX - 1;
+	const int32 MaskY = SizeY - 1;
+	for (int32 Lane = 0; Lane < VAOCEAN_SIMD_WIDTH; Lane++)
+	{
+		const int32 PX0 = X0[Lane] & MaskX;
+		const int32 PX1 = (X0[Lane] + 1) & MaskX;
+		const int32 PY0 = (Y0[Lane] & MaskY) * SizeX;
+		const int32 PY1 = ((Y0[Lane] + 1) & MaskY) * SizeX;
+
+		I00[Lane] = PY0 + PX0;
+		I10[Lane] = PY0 + PX1;
+		I01[Lane] = PY1 + PX0;
+		I11[Lane] = PY1 + PX1;
+
+		H00[Lane] = GetHeight(I00[Lane]);
+		H10[Lane] = GetHeight(I10[Lane]);
+		H01[Lane] = GetHeight(I01[Lane]);
+		H11[Lane] = GetHeight(I11[Lane]);
+	}
+
+	// Heights are filtered for four lanes at once
+	const VectorRegister C00 = VectorLoad(H00);
+	const VectorRegister C10 = VectorLoad(H10);
+	const VectorRegister C01 = VectorLoad(H01);
+	const VectorRegister C11 = VectorLoad(H11);
+
+	const VectorRegister Top = VectorMultiplyAdd(VectorSubtract(C10, C00), FracX, C00);
+	const VectorRegister Bottom = VectorMultiplyAdd(VectorSubtract(C11, C01), FracX, C01);
+
+	float Heights[VAOCEAN_SIMD_WIDTH];
+	VectorStore(VectorMultiplyAdd(VectorSubtract(Bottom, Top), FracY, Top), Heights);
+
+	float FracXValues[VAOCEAN_SIMD_WIDTH], FracYValues[VAOCEAN_SIMD_WIDTH];
+	VectorStore(FracX, FracXValues);
+	VectorStore(FracY, FracYValues);
+
+	// Byte heightmaps don't store gradients, they are taken from neighbour heights
+	const bool bCentralGradients = Gradients.Num() == 0 && HeightBytes.Num() > 0;
+
+	float GradientsX[VAOCEAN_SIMD_WIDTH], GradientsY[VAOCEAN_SIMD_WIDTH];
+	if (Gradients.Num() == 0 && !bCentralGradients)
+	{
+		// Derivatives of bilinear patch
+		const VectorRegister DerivX0 = VectorSubtract(C10, C00);
+		const VectorRegister DerivX1 = VectorSubtract(C11, C01);
+		const VectorRegister DerivX = VectorMultiplyAdd(VectorSubtract(DerivX1, DerivX0), FracY, DerivX0);
+		const VectorRegister DerivY = VectorSubtract(Bottom, Top);
+
+		VectorStore(VectorMultiply(DerivX, VectorSetFloat1(TexelsPerUnitX)), GradientsX);
+		VectorStore(VectorMultiply(DerivY, VectorSetFloat1(TexelsPerUnitY)), GradientsY);
+	}
+
+	// Other channels are filtered per lane, vectorized over components
+	for (int32 Lane = 0; Lane < NumLanes; Lane++)
+	{
+		const VectorRegister Fx = VectorSetFloat1(FracXValues[Lane]);
+		const VectorRegister Fy = VectorSetFloat1(FracYValues[Lane]);
+
+		OutHeights[Lane] = Heights[Lane];
+
+		if (Gradients.Num() > 0)
+		{
+			const FVector2D& G00 = Gradients[I00[Lane]];
+			const FVector2D& G10 = Gradients[I10[Lane]];
+			const FVector2D& G01 = Gradients[I01[Lane]];
+			const FVector2D& G11 = Gradients[I11[Lane]];
+
+			const VectorRegister Gradient = VaVectorBilinear(
+				MakeVectorRegister(G00.X, G00.Y, 0.0f, 0.0f), MakeVectorRegister(G10.X, G10.Y, 0.0f, 0.0f),
+				MakeVectorRegister(G01.X, G01.Y, 0.0f, 0.0f), MakeVectorRegister(G11.X, G11.Y, 0.0f, 0.0f), Fx, Fy);
+
+			float GradientValues[4];
+			VectorStore(Gradient, GradientValues);
+			OutGradients[Lane] = FVector2D(GradientValues[0], GradientValues[1]);
+		}
+		else if (bCentralGradients)
+		{
+			const FVector2D G00 = GetCentralGradient(X0[Lane], Y0[Lane]);
+			const FVector2D G10 = GetCentralGradient(X0[Lane] + 1, Y0[Lane]);
+			const FVector2D G01 = GetCentralGradient(X0[Lane], Y0[Lane] + 1);
+			const FVector2D G11 = GetCentralGradient(X0[Lane] + 1, Y0[Lane] + 1);
+
+			const VectorRegister Gradient = VaVectorBilinear(
+				MakeVectorRegister(G00.X, G00.Y, 0.0f, 0.0f), MakeVectorRegister(G10.X, G10.Y, 0.0f, 0.0f),
+				MakeVectorRegister(G01.X, G01.Y, 0.0f, 0.0f), MakeVectorRegister(G11.X, G11.Y, 0.0f, 0.0f), Fx, Fy);
+
+			float GradientValues[4];
+			VectorStore(Gradient, GradientValues);
+			OutGradients[Lane] = FVector2D(GradientValues[0], GradientValues[1]);
+		}
+		else
+		{
+			OutGradients[Lane] = FVector2D(GradientsX[Lane], GradientsY[Lane]);
+		}
+
+		if (Velocities.Num() > 0)
+		{
+			const VectorRegister Velocity = VaVectorBilinear(
+				VectorLoadFloat3(&Velocities[I00[Lane]]), VectorLoadFloat3(&Velocities[I10[Lane]]),
+				VectorLoadFloat3(&Velocities[I01[Lane]]), VectorLoadFloat3(&Velocities[I11[Lane]]), Fx, Fy);
+
+			VectorStoreFloat3(Velocity, &OutVelocities[Lane]);
+		}
+		else
+		{
+			OutVelocities[Lane] = FVector::ZeroVector;
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanWaveSet
+
+FVaOceanWaveSet::FVaOceanWaveSet()
+	: InverseDisplacementIterations(0)
+{
+}
+
+void FVaOceanWaveSet::Init(const TArray<FGerstnerWave>& Waves, int32 InInverseDisplacementIterations, float TimeScale)
+{
+	InverseDisplacementIterations = InInverseDisplacementIterations;
+
+	// Pad wave count to SIMD width with zero waves
+	const int32 NumWaves = Waves.Num();
+	const int32 NumPadded = (NumWaves + VAOCEAN_SIMD_WIDTH - 1) / VAOCEAN_SIMD_WIDTH * VAOCEAN_SIMD_WIDTH;
+
+	WaveKx.Init(0.0f, NumPadded);
+	WaveKy.Init(0.0f, NumPadded);
+	WaveOmega.Init(0.0f, NumPadded);
+	WavePhase.Init(0.0f, NumPadded);
+	WaveA.Init(0.0f, NumPadded);
+	WaveQADx.Init(0.0f, NumPadded);
+	WaveQADy.Init(0.0f, NumPadded);
+	WaveKADx.Init(0.0f, NumPadded);
+	WaveKADy.Init(0.0f, NumPadded);
+	WaveQKA.Init(0.0f, NumPadded);
+
+	for (int32 i = 0; i < NumWaves; i++)
+	{
+		const FGerstnerWave& Wave = Waves[i];
+		if (Wave.WaveLength <= KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		const FVector2D Direction = Wave.Direction.SafeNormal();
+		const float K = 2.0f * PI / Wave.WaveLength;
+
+		// Steepness is normalized to wave count, so crests can't loop
+		const float Q = FMath::Clamp(Wave.Steepness, 0.0f, 1.0f) / (K * FMath::Max(Wave.Amplitude, KINDA_SMALL_NUMBER) * NumWaves);
+
+		WaveKx[i] = K * Direction.X;
+		WaveKy[i] = K * Direction.Y;
+		WaveOmega[i] = FMath::Sqrt(GRAV_ACCEL * K) * TimeScale;
+		WavePhase[i] = Wave.Phase;
+		WaveA[i] = Wave.Amplitude;
+		WaveQADx[i] = Q * Wave.Amplitude * Direction.X;
+		WaveQADy[i] = Q * Wave.Amplitude * Direction.Y;
+		WaveKADx[i] = K * Wave.Amplitude * Direction.X;
+		WaveKADy[i] = K * Wave.Amplitude * Direction.Y;
+		WaveQKA[i] = Q * K * Wave.Amplitude;
+	}
+}
+
+void FVaOceanWaveSet::InitSpectral(const TArray<FVaOceanSpectralWave>& Waves, float ChoppyScale, int32 InInverseDisplacementIterations)
+{
+	InverseDisplacementIterations = InInverseDisplacementIterations;
+
+	// Pad wave count to SIMD width with zero waves
+	const int32 NumWaves = Waves.Num();
+	const int32 NumPadded = (NumWaves + VAOCEAN_SIMD_WIDTH - 1) / VAOCEAN_SIMD_WIDTH * VAOCEAN_SIMD_WIDTH;
+
+	WaveKx.Init(0.0f, NumPadded);
+	WaveKy.Init(0.0f, NumPadded);
+	WaveOmega.Init(0.0f, NumPadded);
+	WavePhase.Init(0.0f, NumPadded);
+	WaveA.Init(0.0f, NumPadded);
+	WaveQADx.Init(0.0f, NumPadded);
+	WaveQADy.Init(0.0f, NumPadded);
+	WaveKADx.Init(0.0f, NumPadded);
+	WaveKADy.Init(0.0f, NumPadded);
+	WaveQKA.Init(0.0f, NumPadded);
+
+	for (int32 i = 0; i < NumWaves; i++)
+	{
+		const FVaOceanSpectralWave& Wave = Waves[i];
+		const float K = Wave.K.Size();
+		if (K <= KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		// A * cos(k * x + w * t + phi) is A * sin(theta) with theta = -k * x + (pi / 2 - phi) - w * t
+		WaveKx[i] = -Wave.K.X;
+		WaveKy[i] = -Wave.K.Y;
+		WaveOmega[i] = Wave.Omega;
+		WavePhase[i] = HALF_PI - Wave.Phase;
+		WaveA[i] = Wave.Amplitude;
+
+		// FFT choppy displacement is -i * k / |k| * H, so it is ChoppyScale * A * cos(theta) along K
+		WaveQADx[i] = ChoppyScale * Wave.Amplitude * Wave.K.X / K;
+		WaveQADy[i] = ChoppyScale * Wave.Amplitude * Wave.K.Y / K;
+		WaveKADx[i] = -Wave.Amplitude * Wave.K.X;
+		WaveKADy[i] = -Wave.Amplitude * Wave.K.Y;
+		WaveQKA[i] = -ChoppyScale * K * Wave.Amplitude;
+	}
+}
+
+/** Append wave data of one set, amplitude dependent values are scaled */
+static FORCEINLINE void AppendWaveData(TArray<float>& Dest, const TArray<float>& Source, float Scale)
+{
+	const int32 First = Dest.Num();
+	Dest.AddUninitialized(Source.Num());
+
+	for (int32 i = 0; i < Source.Num(); i++)
+	{
+		Dest[First + i] = Source[i] * Scale;
+	}
+}
+
+void FVaOceanWaveSet::InitBlend(const FVaOceanWaveSet& Source, const FVaOceanWaveSet& Target, float Alpha)
+{
+	InverseDisplacementIterations = FMath::Max(Source.InverseDisplacementIterations, Target.InverseDisplacementIterations);
+
+	const FVaOceanWaveSet* Sets[] = { &Source, &Target };
+	const float Scales[] = { 1.0f - Alpha, Alpha };
+
+	WaveKx.Reset();
+	WaveKy.Reset();
+	WaveOmega.Reset();
+	WavePhase.Reset();
+	WaveA.Reset();
+	WaveQADx.Reset();
+	WaveQADy.Reset();
+	WaveKADx.Reset();
+	WaveKADy.Reset();
+	WaveQKA.Reset();
+
+	// Both sets are already padded to SIMD width, so their concatenation is too
+	for (int32 SetIndex = 0; SetIndex < ARRAY_COUNT(Sets); SetIndex++)
+	{
+		const FVaOceanWaveSet& Set = *Sets[SetIndex];
+		const float Scale = Scales[SetIndex];
+
+		AppendWaveData(WaveKx, Set.WaveKx, 1.0f);
+		AppendWaveData(WaveKy, Set.WaveKy, 1.0f);
+		AppendWaveData(WaveOmega, Set.WaveOmega, 1.0f);
+		AppendWaveData(WavePhase, Set.WavePhase, 1.0f);
+		AppendWaveData(WaveA, Set.WaveA, Scale);
+		AppendWaveData(WaveQADx, Set.WaveQADx, Scale);
+		AppendWaveData(WaveQADy, Set.WaveQADy, Scale);
+		AppendWaveData(WaveKADx, Set.WaveKADx, Scale);
+		AppendWaveData(WaveKADy, Set.WaveKADy, Scale);
+		AppendWaveData(WaveQKA, Set.WaveQKA, Scale);
+	}
+}
+
+void FVaOceanWaveSet::Evaluate(float X, float Y, float Time, float& OutHeight, FVector& OutNormal, FVector& OutVelocity) const
+{
+	const int32 NumPadded = WaveKx.Num();
+	const VectorRegister Zero = VectorSetFloat1(0.0f);
+	const VectorRegister TimeV = VectorSetFloat1(Time);
+
+	// Horizontal displacement moves surface points, so find the one that ends up at desired XY
+	float X0 = X;
+	float Y0 = Y;
+	for (int32 Iteration = 0; Iteration < InverseDisplacementIterations; Iteration++)
+	{
+		const VectorRegister PX = VectorSetFloat1(X0);
+		const VectorRegister PY = VectorSetFloat1(Y0);
+		VectorRegister SumDx = Zero;
+		VectorRegister SumDy = Zero;
+
+		for (int32 i = 0; i < NumPadded; i += VAOCEAN_SIMD_WIDTH)
+		{
+			const VectorRegister Phase = VectorSubtract(VectorLoad(&WavePhase[i]), VectorMultiply(VectorLoad(&WaveOmega[i]), TimeV));
+			const VectorRegister Theta = VectorMultiplyAdd(VectorLoad(&WaveKx[i]), PX, VectorMultiplyAdd(VectorLoad(&WaveKy[i]), PY, Phase));
+
+			VectorRegister SinTheta, CosTheta;
+			VaVectorSinCos(Theta, SinTheta, CosTheta);
+
+			SumDx = VectorMultiplyAdd(VectorLoad(&WaveQADx[i]), CosTheta, SumDx);
+			SumDy = VectorMultiplyAdd(VectorLoad(&WaveQADy[i]), CosTheta, SumDy);
+		}
+
+		X0 = X - VaVectorHorizontalSum(SumDx);
+		Y0 = Y - VaVectorHorizontalSum(SumDy);
+	}
+
+	// Evaluate everything at found point
+	const VectorRegister PX = VectorSetFloat1(X0);
+	const VectorRegister PY = VectorSetFloat1(Y0);
+	VectorRegister SumHeight = Zero;
+	VectorRegister SumNx = Zero;
+	VectorRegister SumNy = Zero;
+	VectorRegister SumNz = Zero;
+	VectorRegister SumVx = Zero;
+	VectorRegister SumVy = Zero;
+	VectorRegister SumVz = Zero;
+
+	for (int32 i = 0; i < NumPadded; i += VAOCEAN_SIMD_WIDTH)
+	{
+		const VectorRegister Omega = VectorLoad(&WaveOmega[i]);
+		const VectorRegister Phase = VectorSubtract(VectorLoad(&WavePhase[i]), VectorMultiply(Omega, TimeV));
+		const VectorRegister Theta = VectorMultiplyAdd(VectorLoad(&WaveKx[i]), PX, VectorMultiplyAdd(VectorLoad(&WaveKy[i]), PY, Phase));
+
+		VectorRegister SinTheta, CosTheta;
+		VaVectorSinCos(Theta, SinTheta, CosTheta);
+
+		const VectorRegister A = VectorLoad(&WaveA[i]);
+		const VectorRegister OmegaSin = VectorMultiply(Omega, SinTheta);
+
+		// z = A * sin(theta)
+		SumHeight = VectorMultiplyAdd(A, SinTheta, SumHeight);
+
+		// N = (-k * A * D * cos(theta), 1 - Q * k * A * sin(theta))
+		SumNx = VectorMultiplyAdd(VectorLoad(&WaveKADx[i]), CosTheta, SumNx);
+		SumNy = VectorMultiplyAdd(VectorLoad(&WaveKADy[i]), CosTheta, SumNy);
+		SumNz = VectorMultiplyAdd(VectorLoad(&WaveQKA[i]), SinTheta, SumNz);
+
+		// Orbital velocity is time derivative of the particle position
+		SumVx = VectorMultiplyAdd(VectorLoad(&WaveQADx[i]), OmegaSin, SumVx);
+		SumVy = VectorMultiplyAdd(VectorLoad(&WaveQADy[i]), OmegaSin, SumVy);
+		SumVz = VectorMultiplyAdd(VectorMultiply(A, Omega), CosTheta, SumVz);
+	}
+
+	OutHeight = VaVectorHorizontalSum(SumHeight);
+	OutNormal = FVector(-VaVectorHorizontalSum(SumNx), -VaVectorHorizontalSum(SumNy), 1.0f - VaVectorHorizontalSum(SumNz)).SafeNormal();
+	OutVelocity = FVector(VaVectorHorizontalSum(SumVx), VaVectorHorizontalSum(SumVy), -VaVectorHorizontalSum(SumVz));
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanPhysicsLOD
+
+FVaOceanPhysicsLOD::FVaOceanPhysicsLOD()
+	: MinWaveLength(0.0f)
+{
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanSnapshot
+
+/** Water particle velocity of linear deep water wave pattern that travels with phase velocity */
+static FORCEINLINE FVector GetTravellingWaveVelocity(const FVector& PhaseVelocity, float WaveNumber, float Height, const FVector2D& Gradient)
+{
+	// Horizontal orbital velocity is omega * eta along travel direction, vertical one is time derivative of moved height field
+	return FVector(
+		PhaseVelocity.X * WaveNumber * Height,
+		PhaseVelocity.Y * WaveNumber * Height,
+		-(PhaseVelocity.X * Gradient.X + PhaseVelocity.Y * Gradient.Y));
+}
+
+/** Choppy cascades move surface points horizontally, so find the one that ends up at desired XY: X0 = X - D(X0) */
+static void FindUndisplacedLocation(const TArray<FVaOceanGridPtr>& Cascades, int32 NumCascades, int32 Iterations, float& X, float& Y)
+{
+	const float TargetX = X;
+	const float TargetY = Y;
+
+	for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		FVector2D Displacement = FVector2D::ZeroVector;
+		for (int32 CascadeIndex = 0; CascadeIndex < NumCascades; CascadeIndex++)
+		{
+			const FVaOceanGrid& Cascade = *Cascades[CascadeIndex];
+			Displacement += Cascade.SampleHorizontal(X * Cascade.TexelsPerUnitX, Y * Cascade.TexelsPerUnitY);
+		}
+
+		X = TargetX - Displacement.X;
+		Y = TargetY - Displacement.Y;
+	}
+}
+
+/** Same as FindUndisplacedLocation, for four locations at once */
+static void FindUndisplacedLocation4(const TArray<FVaOceanGridPtr>& Cascades, int32 NumCascades, int32 Iterations, VectorRegister& X, VectorRegister& Y)
+{
+	const VectorRegister TargetX = X;
+	const VectorRegister TargetY = Y;
+
+	for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		VectorRegister SumDx = VectorSetFloat1(0.0f);
+		VectorRegister SumDy = VectorSetFloat1(0.0f);
+		for (int32 CascadeIndex = 0; CascadeIndex < NumCascades; CascadeIndex++)
+		{
+			const FVaOceanGrid& Cascade = *Cascades[CascadeIndex];
+
+			VectorRegister Dx, Dy;
+			Cascade.SampleHorizontal4(VectorMultiply(X, VectorSetFloat1(Cascade.TexelsPerUnitX)), VectorMultiply(Y, VectorSetFloat1(Cascade.TexelsPerUnitY)), Dx, Dy);
+
+			SumDx = VectorAdd(SumDx, Dx);
+			SumDy = VectorAdd(SumDy, Dy);
+		}
+
+		X = VectorSubtract(TargetX, SumDx);
+		Y = VectorSubtract(TargetY, SumDy);
+	}
+}
+
+FVaOceanSnapshot::FVaOceanSnapshot()
+	: FrameNumber(0)
+	, Time(0.0f)
+	, TimeRate(1.0f)
+	, OceanLevel(0.0f)
+	, GridOffsetX(0.0f)
+	, GridOffsetY(0.0f)
+	, GridPhaseVelocity(FVector::ZeroVector)
+	, GridWaveNumber(0.0f)
+	, CascadeInverseIterations(0)
+	, BakedFrameA(0)
+	, BakedFrameB(0)
+	, BakedFrameAlpha(0.0f)
+{
+}
+
+int32 FVaOceanSnapshot::FindPhysicsLOD(float WaveLength) const
+{
+	// LODs are sorted by wave length
+	int32 Result = INDEX_NONE;
+	for (int32 LODIndex = 0; LODIndex < PhysicsLODs.Num() && PhysicsLODs[LODIndex].MinWaveLength <= WaveLength; LODIndex++)
+	{
+		Result = LODIndex;
+	}
+
+	return Result;
+}
+
+const TArray<FVaOceanGridPtr>& FVaOceanSnapshot::GetCascadeGrids(int32 PhysicsLOD) const
+{
+	return PhysicsLODs.IsValidIndex(PhysicsLOD) ? PhysicsLODs[PhysicsLOD].CascadeGrids : CascadeGrids;
+}
+
+void FVaOceanSnapshot::Sample(const FVector& Location, float& OutLevel, FVector& OutNormal, FVector& OutVelocity, int32 MaxCascades, int32 PhysicsLOD) const
+{
+	float Level = OceanLevel;
+	FVector2D Gradient = FVector2D::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+
+	if (Grid.IsValid())
+	{
+		float GridHeight;
+		FVector2D GridGradient;
+		FVector GridPointVelocity;
+		Grid->Sample(
+			Location.X * Grid->TexelsPerUnitX + GridOffsetX,
+			Location.Y * Grid->TexelsPerUnitY + GridOffsetY,
+			GridHeight, GridGradient, GridPointVelocity);
+
+		Level += GridHeight;
+		Gradient += GridGradient;
+		Velocity += GridPointVelocity + GetTravellingWaveVelocity(GridPhaseVelocity, GridWaveNumber, GridHeight - Grid->MeanHeight, GridGradient);
+	}
+
+	const TArray<FVaOceanGridPtr>& Cascades = GetCascadeGrids(PhysicsLOD);
+	const int32 NumCascades = FMath::Min(Cascades.Num(), MaxCascades);
+
+	float CascadeX = Location.X;
+	float CascadeY = Location.Y;
+	FindUndisplacedLocation(Cascades, NumCascades, CascadeInverseIterations, CascadeX, CascadeY);
+
+	for (int32 CascadeIndex = 0; CascadeIndex < NumCascades; CascadeIndex++)
+	{
+		const FVaOceanGrid& Cascade = *Cascades[CascadeIndex];
+
+		float CascadeHeight;
+		FVector2D CascadeGradient;
+		FVector CascadeVelocity;
+		Cascade.Sample(CascadeX * Cascade.TexelsPerUnitX, CascadeY * Cascade.TexelsPerUnitY, CascadeHeight, CascadeGradient, CascadeVelocity);
+
+		Level += CascadeHeight;
+		Gradient += CascadeGradient;
+		Velocity += CascadeVelocity;
+	}
+
+	if (WaveSet.IsValid())
+	{
+		float WaveHeight;
+		FVector WaveNormal, WaveVelocity;
+		WaveSet->Evaluate(Location.X, Location.Y, Time, WaveHeight, WaveNormal, WaveVelocity);
+
+		Level += WaveHeight;
+		Gradient += FVector2D(-WaveNormal.X, -WaveNormal.Y) / FMath::Max(WaveNormal.Z, KINDA_SMALL_NUMBER);
+		Velocity += WaveVelocity;
+	}
+
+	if (BakedAnimation.IsValid())
+	{
+		float BakedHeight;
+		FVector2D BakedGradient;
+		FVector BakedVelocity;
+		BakedAnimation->Sample(BakedFrameA, BakedFrameB, BakedFrameAlpha, Location.X, Location.Y, BakedHeight, BakedGradient, BakedVelocity);
+
+		Level += BakedHeight;
+		Gradient += BakedGradient;
+		Velocity += BakedVelocity;
+	}
+
+	OutLevel = Level;
+	OutNormal = FVector(-Gradient.X, -Gradient.Y, 1.0f).SafeNormal();
+
+	// Scale to the world size (in m/sec!)
+	OutVelocity = Velocity * (TimeRate / 100.0f);
+}
+
+void FVaOceanSnapshot::SampleBatch(const TArray<FVector>& Locations, TArray<float>& OutLevels, TArray<FVector>& OutNormals, TArray<FVector>& OutVelocities, int32 MaxCascades, int32 PhysicsLOD) const
+{
+	const int32 NumLocations = Locations.Num();
+
+	OutLevels.Empty(NumLocations);
+	OutLevels.AddUninitialized(NumLocations);
+	OutNormals.Empty(NumLocations);
+	OutNormals.AddUninitialized(NumLocations);
+	OutVelocities.Empty(NumLocations);
+	OutVelocities.AddUninitialized(NumLocations);
+
+	if (NumLocations > 0)
+	{
+		SampleBatch(Locations.GetTypedData(), NumLocations, OutLevels.GetTypedData(), OutNormals.GetTypedData(), OutVelocities.GetTypedData(), MaxCascades, PhysicsLOD);
+	}
+}
+
+void FVaOceanSnapshot::SampleBatch(const FVector* Locations, int32 NumLocations, float* OutLevels, FVector* OutNormals, FVector* OutVelocities, int32 MaxCascades, int32 PhysicsLOD) const
+{
+	VectorRegister TexelsPerUnitX = VectorSetFloat1(0.0f);
+	VectorRegister TexelsPerUnitY = VectorSetFloat1(0.0f);
+	if (Grid.IsValid())
+	{
+		TexelsPerUnitX = VectorSetFloat1(Grid->TexelsPerUnitX);
+		TexelsPerUnitY = VectorSetFloat1(Grid->TexelsPerUnitY);
+	}
+
+	const float GridMeanHeight = Grid.IsValid() ? Grid->MeanHeight : 0.0f;
+
+	const VectorRegister OffsetX = VectorSetFloat1(GridOffsetX);
+	const VectorRegister OffsetY = VectorSetFloat1(GridOffsetY);
+
+	const TArray<FVaOceanGridPtr>& Cascades = GetCascadeGrids(PhysicsLOD);
+	const int32 NumCascades = FMath::Min(Cascades.Num(), MaxCascades);
+
+	for (int32 First = 0; First < NumLocations; First += VAOCEAN_SIMD_WIDTH)
+	{
+		const int32 NumLanes = FMath::Min(VAOCEAN_SIMD_WIDTH, NumLocations - First);
+
+		float Heights[VAOCEAN_SIMD_WIDTH] = { 0.0f };
+		FVector2D Gradients[VAOCEAN_SIMD_WIDTH];
+		FVector Velocities[VAOCEAN_SIMD_WIDTH];
+
+		if (Grid.IsValid())
+		{
+			// Texel coords of four locations at once
+			VectorRegister TexelX, TexelY;
+			VaVectorLoadXY(&Locations[First], NumLanes, TexelX, TexelY);
+			TexelX = VectorMultiplyAdd(TexelX, TexelsPerUnitX, OffsetX);
+			TexelY = VectorMultiplyAdd(TexelY, TexelsPerUnitY, OffsetY);
+
+			Grid->Sample4(TexelX, TexelY, NumLanes, Heights, Gradients, Velocities);
+		}
+		else
+		{
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)
+			{
+				Gradients[Lane] = FVector2D::ZeroVector;
+				Velocities[Lane] = FVector::ZeroVector;
+			}
+		}
+
+		float CascadeHeights[VAOCEAN_SIMD_WIDTH] = { 0.0f };
+		FVector2D CascadeGradients[VAOCEAN_SIMD_WIDTH];
+		FVector CascadeVelocities[VAOCEAN_SIMD_WIDTH];
+		for (int32 Lane = 0; Lane < NumLanes; Lane++)
+		{
+			CascadeGradients[Lane] = FVector2D::ZeroVector;
+			CascadeVelocities[Lane] = FVector::ZeroVector;
+		}
+
+		VectorRegister CascadeX, CascadeY;
+		VaVectorLoadXY(&Locations[First], NumLanes, CascadeX, CascadeY);
+		FindUndisplacedLocation4(Cascades, NumCascades, CascadeInverseIterations, CascadeX, CascadeY);
+
+		for (int32 CascadeIndex = 0; CascadeIndex < NumCascades; CascadeIndex++)
+		{
+			const FVaOceanGrid& Cascade = *Cascades[CascadeIndex];
+
+			const VectorRegister TexelX = VectorMultiply(CascadeX, VectorSetFloat1(Cascade.TexelsPerUnitX));
+			const VectorRegister TexelY = VectorMultiply(CascadeY, VectorSetFloat1(Cascade.TexelsPerUnitY));
+
+			float LayerHeights[VAOCEAN_SIMD_WIDTH];
+			FVector2D LayerGradients[VAOCEAN_SIMD_WIDTH];
+			FVector LayerVelocities[VAOCEAN_SIMD_WIDTH];
+			Cascade.Sample4(TexelX, TexelY, NumLanes, LayerHeights, LayerGradients, LayerVelocities);
+
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)
+			{
+				CascadeHeights[Lane] += LayerHeights[Lane];
+				CascadeGradients[Lane] += LayerGradients[Lane];
+				CascadeVelocities[Lane] += LayerVelocities[Lane];
+			}
+		}
+
+		for (int32 Lane = 0; Lane < NumLanes; Lane++)
+		{
+			const int32 Index = First + Lane;
+
+			float Level = OceanLevel + Heights[Lane] + CascadeHeights[Lane];
+			FVector2D Gradient = Gradients[Lane] + CascadeGradients[Lane];
+			FVector Velocity = Velocities[Lane] + CascadeVelocities[Lane] + GetTravellingWaveVelocity(GridPhaseVelocity, GridWaveNumber, Heights[Lane] - GridMeanHeight, Gradients[Lane]);
+
+			if (WaveSet.IsValid())
+			{
+				float WaveHeight;
+				FVector WaveNormal, WaveVelocity;
+				WaveSet->Evaluate(Locations[Index].X, Locations[Index].Y, Time, WaveHeight, WaveNormal, WaveVelocity);
+
+				Level += WaveHeight;
+				Gradient += FVector2D(-WaveNormal.X, -WaveNormal.Y) / FMath::Max(WaveNormal.Z, KINDA_SMALL_NUMBER);
+				Velocity += WaveVelocity;
+			}
+
+			if (BakedAnimation.IsValid())
+			{
+				float BakedHeight;
+				FVector2D BakedGradient;
+				FVector BakedVelocity;
+				BakedAnimation->Sample(BakedFrameA, BakedFrameB, BakedFrameAlpha, Locations[Index].X, Locations[Index].Y, BakedHeight, BakedGradient, BakedVelocity);
+
+				Level += BakedHeight;
+				Gradient += BakedGradient;
+				Velocity += BakedVelocity;
+			}
+
+			OutLevels[Index] = Level;
+			OutNormals[Index] = FVector(-Gradient.X, -Gradient.Y, 1.0f).SafeNormal();
+
+			// Scale to the world size (in m/sec!)
+			OutVelocities[Index] = Velocity * (TimeRate / 100.0f);
+		}
+	}
+}
@@ -0,0 +1,53 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+#define HALF_SQRT_2	0.7071068f
+#define GRAV_ACCEL	981.0f	// The acceleration of gravity, cm/s^2
+
+/** Generating gaussian random number with mean 0 and standard deviation 1 */
+FORCEINLINE float VaOceanGauss(FRandomStream& RandomStream)
+{
+	float U1 = RandomStream.FRand();
+	float U2 = RandomStream.FRand();
+
+	if (U1 < 1e-6f)
+	{
+		U1 = 1e-6f;
+	}
+
+	return FMath::Sqrt(-2.0f * FMath::Loge(U1)) * FMath::Cos(2.0f * PI * U2);
+}
+
+/**
+ * Phillips Spectrum
+ * K: normalized wave vector, W: wind direction, v: wind velocity, a: amplitude constant
+ */
+FORCEINLINE float VaOceanPhillips(FVector2D K, FVector2D W, float V, float A, float DirDepend)
+{
+	// Largest possible wave from constant wind of velocity v
+	const float L = V * V / GRAV_ACCEL;
+
+	// Damp out waves with very small length w << l
+	const float Wl = L / 1000.0f;
+
+	const float Ksqr = K.X * K.X + K.Y * K.Y;
+	const float Kcos = K.X * W.X + K.Y * W.Y;
+	float Phillips = A * FMath::Exp(-1.0f / (L * L * Ksqr)) / (Ksqr * Ksqr * Ksqr) * (Kcos * Kcos);
+
+	// Filter out waves moving opposite to wind
+	if (Kcos < 0)
+	{
+		Phillips *= DirDepend;
+	}
+
+	// Damp out waves with very small length w << l
+	return Phillips * FMath::Exp(-Ksqr * Wl * Wl);
+}
+
+/** Amplitude constant of Phillips spectrum for desired config */
+FORCEINLINE float VaOceanPhillipsAmplitude(const FSpectrumData& SpectrumConfig)
+{
+	// It is too small. We must scale it for editing.
+	return SpectrumConfig.WaveAmplitude * 1e-7f;
+}
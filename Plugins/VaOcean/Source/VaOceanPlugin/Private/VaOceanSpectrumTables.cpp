@@ -0,0 +1,262 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanSpectrumTables::FKey
+
+FVaOceanSpectrumTables::FKey::FKey()
+{
+	// Key is hashed and compared as raw memory
+	FMemory::Memzero(this, sizeof(FKey));
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FVaOceanSpectrumTables
+
+FVaOceanSpectrumTables::FVaOceanSpectrumTables()
+	: H0(NULL)
+	, Omega(NULL)
+	, NextRow(0)
+{
+}
+
+void FVaOceanSpectrumTables::LoadOrGenerate(const FKey& InKey, bool bUseCache)
+{
+	check(FMath::IsPowerOfTwo(InKey.Dim));
+
+	Key = InKey;
+
+	const FString Filename = GetCacheFilename(Key);
+	if (bUseCache && Load(Filename))
+	{
+		UE_LOG(LogVaOcean, Log, TEXT("Ocean spectrum %dx%d is loaded from cache (%s)"), Key.Dim, Key.Dim, File.IsMapped() ? TEXT("mapped") : TEXT("loaded"));
+		return;
+	}
+
+	Generate();
+
+	if (bUseCache)
+	{
+		Save(Filename);
+	}
+}
+
+void FVaOceanSpectrumTables::InitBandLimited(const FVaOceanSpectrumTables& Source, int32 InDim)
+{
+	check(Source.IsValid() && FMath::IsPowerOfTwo(InDim) && InDim < Source.Key.Dim);
+
+	Key = Source.Key;
+	Key.Dim = InDim;
+	Key.MaxWaveNumber = PI * InDim / Source.Key.PatchLength;
+
+	// Wave vectors of the same patch length are the same, so the central block of
+	// source tables gives exactly the same waves without the short ones
+	const int32 InWidth = InDim + 4;
+	const int32 SourceInWidth = Source.Key.Dim + 4;
+	const int32 Offset = (Source.Key.Dim - InDim) / 2;
+
+	H0Data.Empty(InWidth * (InDim + 1));
+	H0Data.AddZeroed(InWidth * (InDim + 1));
+	OmegaData.Empty(InWidth * (InDim + 1));
+	OmegaData.AddZeroed(InWidth * (InDim + 1));
+
+	for (int32 i = 0; i <= InDim; i++)
+	{
+		for (int32 j = 0; j <= InDim; j++)
+		{
+			const int32 SourceIndex = (i + Offset) * SourceInWidth + (j + Offset);
+			H0Data[i * InWidth + j] = Source.H0[SourceIndex];
+			OmegaData[i * InWidth + j] = Source.Omega[SourceIndex];
+		}
+	}
+
+	File.Close();
+	H0 = H0Data.GetTypedData();
+	Omega = OmegaData.GetTypedData();
+}
+
+bool FVaOceanSpectrumTables::IsValid() const
+{
+	return H0 != NULL && Omega != NULL;
+}
+
+const FVaOceanSpectrumTables::FKey& FVaOceanSpectrumTables::GetKey() const
+{
+	return Key;
+}
+
+const FVector2D* FVaOceanSpectrumTables::GetH0() const
+{
+	return H0;
+}
+
+const float* FVaOceanSpectrumTables::GetOmega() const
+{
+	return Omega;
+}
+
+void FVaOceanSpectrumTables::Generate()
+{
+	BeginGenerate(Key);
+	GenerateRows(MAX_int32);
+}
+
+void FVaOceanSpectrumTables::BeginGenerate(const FKey& InKey)
+{
+	check(FMath::IsPowerOfTwo(InKey.Dim));
+
+	Key = InKey;
+
+	const int32 InWidth = Key.Dim + 4;
+	const int32 InputSize = InWidth * (Key.Dim + 1);
+
+	File.Close();
+	H0Data.Init(FVector2D::ZeroVector, InputSize);
+	OmegaData.Init(0.0f, InputSize);
+
+	// Tables are invalid until the last row is done
+	H0 = NULL;
+	Omega = NULL;
+
+	// Initialize random generator
+	RandomStream.Initialize(Key.RandomSeed);
+	NextRow = 0;
+}
+
+bool FVaOceanSpectrumTables::GenerateRows(int32 MaxRows)
+{
+	const int32 Dim = Key.Dim;
+	const int32 InWidth = Dim + 4;
+	const int32 LastRow = (int32)FMath::Min<int64>((int64)NextRow + MaxRows, Dim + 1);
+
+	const FVector2D WindDir(Key.WindDirectionX, Key.WindDirectionY);
+	const float MinSqrK = FMath::Square(Key.MinWaveNumber);
+	const float MaxSqrK = (Key.MaxWaveNumber > 0.0f) ? FMath::Square(Key.MaxWaveNumber) : MAX_flt;
+
+	FVector2D K;
+	for (int32 i = NextRow; i < LastRow; i++)
+	{
+		// K is wave-vector, range [-|DX/W, |DX/W], [-|DY/H, |DY/H]
+		K.Y = (-Dim / 2.0f + i) * (2 * PI / Key.PatchLength);
+
+		for (int32 j = 0; j <= Dim; j++)
+		{
+			K.X = (-Dim / 2.0f + j) * (2 * PI / Key.PatchLength);
+
+			const float SqrK = K.SizeSquared();
+			const bool bInBand = (SqrK >= MinSqrK && SqrK < MaxSqrK);
+			const float Phil = (K.X == 0 && K.Y == 0) ? 0 : FMath::Sqrt(VaOceanPhillips(K, WindDir, Key.WindSpeed, Key.Amplitude, Key.WindDependency));
+
+			// Random numbers are taken for all modes, so band limits don't change the waves
+			const float GaussX = VaOceanGauss(RandomStream);
+			const float GaussY = VaOceanGauss(RandomStream);
+
+			if (bInBand)
+			{
+				H0Data[i * InWidth + j].X = Phil * GaussX * HALF_SQRT_2;
+				H0Data[i * InWidth + j].Y = Phil * GaussY * HALF_SQRT_2;
+			}
+
+			// The angular frequency is following the dispersion relation:
+			//            Omega^2 = g * k
+			float W = FMath::Sqrt(GRAV_ACCEL * K.Size());
+			if (Key.LoopOmega > 0.0f)
+			{
+				W = FMath::FloorToFloat(W / Key.LoopOmega) * Key.LoopOmega;
+			}
+
+			OmegaData[i * InWidth + j] = W;
+		}
+	}
+	NextRow = LastRow;
+
+	if (NextRow <= Dim)
+	{
+		return false;
+	}
+
+	H0 = H0Data.GetTypedData();
+	Omega = OmegaData.GetTypedData();
+
+	return true;
+}
+
+bool FVaOceanSpectrumTables::Load(const FString& Filename)
+{
+	if (!IFileManager::Get().FileExists(*Filename) || !File.Open(Filename))
+	{
+		return false;
+	}
+
+	const int64 NumEntries = (int64)(Key.Dim + 4) * (Key.Dim + 1);
+	const uint8* Data = File.GetData();
+	const FHeader* Header = (const FHeader*)Data;
+
+	// Hash collision or stale file from older version is just a cache miss
+	if (File.GetSize() < (int64)sizeof(FHeader) || Header->Magic != FileMagic || Header->Version != FileVersion ||
+		FMemory::Memcmp(&Header->Key, &Key, sizeof(FKey)) != 0 ||
+		File.GetSize() < (int64)Header->H0Offset + NumEntries * (int64)sizeof(FVector2D) ||
+		File.GetSize() < (int64)Header->OmegaOffset + NumEntries * (int64)sizeof(float) ||
+		!IsAligned(Header->H0Offset, 16) || !IsAligned(Header->OmegaOffset, 16))
+	{
+		File.Close();
+		return false;
+	}
+
+	H0Data.Empty();
+	OmegaData.Empty();
+	H0 = (const FVector2D*)(Data + Header->H0Offset);
+	Omega = (const float*)(Data + Header->OmegaOffset);
+
+	return true;
+}
+
+void FVaOceanSpectrumTables::Save(const FString& Filename) const
+{
+	const int32 NumEntries = (Key.Dim + 4) * (Key.Dim + 1);
+
+	FHeader Header;
+	FMemory::Memzero(&Header, sizeof(FHeader));
+	Header.Magic = FileMagic;
+	Header.Version = FileVersion;
+	Header.Key = Key;
+	Header.H0Offset = Align(sizeof(FHeader), 16);
+	Header.OmegaOffset = Align(Header.H0Offset + NumEntries * sizeof(FVector2D), 16);
+
+	// Other processes can map the same file, so it appears under its name only when it's complete
+	const FString TempFilename = FString::Printf(TEXT("%s.%08X.tmp"), *Filename, FPlatformTLS::GetCurrentThreadId());
+
+	FArchive* Writer = IFileManager::Get().CreateFileWriter(*TempFilename);
+	if (Writer == NULL)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Can't create ocean spectrum cache file %s"), *TempFilename);
+		return;
+	}
+
+	TArray<uint8> Padding;
+	Padding.AddZeroed(16);
+
+	Writer->Serialize(&Header, sizeof(FHeader));
+	Writer->Serialize(Padding.GetTypedData(), Header.H0Offset - sizeof(FHeader));
+	Writer->Serialize((void*)H0, NumEntries * sizeof(FVector2D));
+	Writer->Serialize(Padding.GetTypedData(), Header.OmegaOffset - (Header.H0Offset + NumEntries * sizeof(FVector2D)));
+	Writer->Serialize((void*)Omega, NumEntries * sizeof(float));
+
+	const bool bSuccess = !Writer->IsError();
+	Writer->Close();
+	delete Writer;
+
+	if (!bSuccess || !IFileManager::Get().Move(*Filename, *TempFilename, true))
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Can't write ocean spectrum cache file %s"), *Filename);
+		IFileManager::Get().Delete(*TempFilename, false, false, true);
+	}
+}
+
+FString FVaOceanSpectrumTables::GetCacheFilename(const FKey& Key)
+{
+	const uint32 Hash = FCrc::MemCrc32(&Key, sizeof(FKey));
+	return FPaths::GameSavedDir() / TEXT("VaOcean") / FString::Printf(TEXT("Spectrum_%08X_%d.bin"), Hash, Key.Dim);
+}
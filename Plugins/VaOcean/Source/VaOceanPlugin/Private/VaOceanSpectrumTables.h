@@ -0,0 +1,190 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+/**
+ * Initial spectrum of one FFT patch: H(0) and Omega in VaOcean_CS.usf layout, (Dim + 1) x (Dim + 4).
+ * Generated tables are cached to a file keyed by spectrum parameters, next time the file
+ * is just mapped into memory.
+ */
+class FVaOceanSpectrumTables
+{
+public:
+	/** Everything tables depend on. Is hashed to get cache file name and stored in it to check for collisions. */
+	struct FKey
+	{
+		int32 Dim;
+		float PatchLength;
+
+		/** Phillips amplitude constant, already scaled for patch length */
+		float Amplitude;
+
+		/** Band of wave numbers [rad/uu], zero max means no upper limit */
+		float MinWaveNumber;
+		float MaxWaveNumber;
+
+		/** Normalized wind direction */
+		float WindDirectionX;
+		float WindDirectionY;
+		float WindSpeed;
+		float WindDependency;
+
+		/** Base frequency of looping animation, zero if it doesn't loop */
+		float LoopOmega;
+
+		int32 RandomSeed;
+
+		FKey();
+	};
+
+	FVaOceanSpectrumTables();
+
+	/** Map cached tables or generate them (and cache if allowed). Can be called from any thread. */
+	void LoadOrGenerate(const FKey& InKey, bool bUseCache);
+
+	/** Start generation without cache, rows are generated by GenerateRows() then */
+	void BeginGenerate(const FKey& InKey);
+
+	/** Generate next rows of tables, returns true when the last row is done and tables are valid */
+	bool GenerateRows(int32 MaxRows);
+
+	/** Take the lowest frequencies of other tables, so the same waves are simulated with smaller grid */
+	void InitBandLimited(const FVaOceanSpectrumTables& Source, int32 InDim);
+
+	/** Are tables ready to be used */
+	bool IsValid() const;
+
+	/** Parameters of the tables */
+	const FKey& GetKey() const;
+
+	/** Table data, both have the same layout */
+	const FVector2D* GetH0() const;
+	const float* GetOmega() const;
+
+	/** Cache file magic and version, version should be increased each time generation changes */
+	static const uint32 FileMagic = 0x53534F56;	// "VOSS"
+	static const uint32 FileVersion = 1;
+
+private:
+	/** Cache file header */
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		FKey Key;
+
+		/** Offsets of tables from file start */
+		uint32 H0Offset;
+		uint32 OmegaOffset;
+	};
+
+	/** Generate all tables from random stream */
+	void Generate();
+
+	/** Map cache file and check it was made for the same key */
+	bool Load(const FString& Filename);
+
+	/** Write generated tables to cache file */
+	void Save(const FString& Filename) const;
+
+	/** Cache file of desired key */
+	static FString GetCacheFilename(const FKey& Key);
+
+	FKey Key;
+
+	/** Mapped cache file */
+	FVaOceanMappedFile File;
+
+	/** Generated tables (when there is no cache file) */
+	TArray<FVector2D> H0Data;
+	TArray<float> OmegaData;
+
+	/** Either mapped or generated tables */
+	const FVector2D* H0;
+	const float* Omega;
+
+	/** Generation state, random numbers are taken row by row */
+	FRandomStream RandomStream;
+	int32 NextRow;
+};
+
+typedef TSharedPtr<FVaOceanSpectrumTables, ESPMode::ThreadSafe> FVaOceanSpectrumTablesPtr;
+
+/** Task that loads or generates spectrum tables off the game thread */
+class FVaOceanSpectrumTablesTask
+{
+public:
+	FVaOceanSpectrumTablesTask(const TArray<FVaOceanSpectrumTablesPtr>& InTables, const TArray<FVaOceanSpectrumTables::FKey>& InKeys, bool bInUseCache)
+		: Tables(InTables)
+		, Keys(InKeys)
+		, bUseCache(bInUseCache)
+	{
+	}
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FVaOceanSpectrumTablesTask, STATGROUP_TaskGraphTasks);
+	}
+
+	static ENamedThreads::Type GetDesiredThread()
+	{
+		return ENamedThreads::AnyThread;
+	}
+
+	static ESubsequentsMode::Type GetSubsequentsMode()
+	{
+		return ESubsequentsMode::TrackSubsequents;
+	}
+
+	void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+	{
+		for (int32 Index = 0; Index < Tables.Num(); Index++)
+		{
+			Tables[Index]->LoadOrGenerate(Keys[Index], bUseCache);
+		}
+	}
+
+private:
+	/** Tables are shared, so they outlive the simulator if it's destroyed first */
+	TArray<FVaOceanSpectrumTablesPtr> Tables;
+	TArray<FVaOceanSpectrumTables::FKey> Keys;
+	bool bUseCache;
+};
+
+/** Task that generates next rows of spectrum tables, so the rebuild cost is spread over frames */
+class FVaOceanSpectrumRowsTask
+{
+public:
+	FVaOceanSpectrumRowsTask(const TArray<FVaOceanSpectrumTablesPtr>& InTables, int32 InMaxRows)
+		: Tables(InTables)
+		, MaxRows(InMaxRows)
+	{
+	}
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FVaOceanSpectrumRowsTask, STATGROUP_TaskGraphTasks);
+	}
+
+	static ENamedThreads::Type GetDesiredThread()
+	{
+		return ENamedThreads::AnyThread;
+	}
+
+	static ESubsequentsMode::Type GetSubsequentsMode()
+	{
+		return ESubsequentsMode::TrackSubsequents;
+	}
+
+	void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+	{
+		for (int32 Index = 0; Index < Tables.Num(); Index++)
+		{
+			Tables[Index]->GenerateRows(MaxRows);
+		}
+	}
+
+private:
+	TArray<FVaOceanSpectrumTablesPtr> Tables;
+	int32 MaxRows;
+};
@@ -47,12 +47,29 @@ AVaOceanStateActor::AVaOceanStateActor(const class FPostConstructInitializePrope
 	}
 #endif // WITH_EDITORONLY_DATA
 
-	//OceanSimulator = NULL;
+	OceanSimulator = NULL;
+
+	// Snapshot is published each frame
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Ocean clock is driven by server
+	bReplicates = true;
+	bAlwaysRelevant = true;
+
+	bUnboundedRegion = true;
+	RegionExtent = FVector2D(100000.0f, 100000.0f);
+	RegionPriority = 0;
+
+	OceanClockSyncInterval = 2.0f;
+	InitialServerTime = 0.0f;
+	LocalClockBaseTime = 0.0f;
+	LastClockSyncTime = 0.0f;
+	NumClockUpdates = 0;
 }
 
 void AVaOceanStateActor::PreInitializeComponents()
 {
-	//OceanSimulator = FindComponentByClass<UVaOceanSimulatorComponent>();
+	OceanSimulator = FindComponentByClass<UVaOceanSimulatorComponent>();
 
 	Super::PreInitializeComponents();
 }
@@ -60,6 +77,83 @@ void AVaOceanStateActor::PreInitializeComponents()
 void AVaOceanStateActor::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
+
+	// Ocean time starts with the world time, clients will get server's one with replication
+	if (Role == ROLE_Authority)
+	{
+		const float WorldTime = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0f;
+
+		OceanClock.BaseOceanTime = WorldTime;
+		OceanClock.BaseServerTime = WorldTime;
+		InitialServerTime = WorldTime;
+		LocalClockBaseTime = WorldTime;
+		LastClockSyncTime = WorldTime;
+	}
+
+	// Snapshot should use displacement grid of the same frame
+	if (OceanSimulator)
+	{
+		AddTickPrerequisiteComponent(OceanSimulator);
+	}
+
+	// Let consumers sample the ocean right after spawn
+	UpdateOceanSnapshot();
+
+	if (GetWorld())
+	{
+		FVaOceanRegistry::Get(GetWorld()).Register(this);
+	}
+}
+
+void AVaOceanStateActor::Destroyed()
+{
+	if (GetWorld())
+	{
+		FVaOceanRegistry::Get(GetWorld()).Unregister(this);
+	}
+
+	Super::Destroyed();
+}
+
+#if WITH_EDITOR
+void AVaOceanStateActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Region could be changed
+	if (GetWorld())
+	{
+		FVaOceanRegistry::Get(GetWorld()).Register(this);
+	}
+}
+#endif // WITH_EDITOR
+
+void AVaOceanStateActor::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Joining clients get it with their first time base
+	if (Role == ROLE_Authority)
+	{
+		InitialServerTime = GetWorld()->GetTimeSeconds();
+	}
+
+	// Fresh time base lets clients correct the drift with current ping
+	if (Role == ROLE_Authority && GetWorld()->GetTimeSeconds() - LastClockSyncTime >= OceanClockSyncInterval)
+	{
+		ResyncOceanClock();
+	}
+
+	UpdateOceanSnapshot();
+}
+
+void AVaOceanStateActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AVaOceanStateActor, OceanClock);
+	DOREPLIFETIME_CONDITION(AVaOceanStateActor, InitialServerTime, COND_InitialOnly);
+	DOREPLIFETIME(AVaOceanStateActor, SeaState);
 }
 
 
@@ -73,23 +167,39 @@ const FSpectrumData& AVaOceanStateActor::GetSpectrumConfig() const
 
 float AVaOceanStateActor::GetOceanLevelAtLocation(FVector& Location) const
 {
-	// @TODO Get altitute from ocean simulation component
+	float OceanLevel;
+	FVector Normal, Velocity;
+	GetSnapshotForSampling()->Sample(Location, OceanLevel, Normal, Velocity);
 
-	return GetGlobalOceanLevel();
+	return OceanLevel;
 }
 
-FLinearColor AVaOceanStateActor::GetOceanSurfaceNormal(FVector& Location) const
+FVector AVaOceanStateActor::GetOceanSurfaceNormal(FVector& Location) const
 {
-	// @TODO Get surface normals from ocean simulation component
+	float OceanLevel;
+	FVector Normal, Velocity;
+	GetSnapshotForSampling()->Sample(Location, OceanLevel, Normal, Velocity);
 
-	return FLinearColor::Blue;
+	return Normal;
 }
 
 FVector AVaOceanStateActor::GetOceanWaveVelocity(FVector& Location) const
 {
-	// @TODO Velocity should be calculated in ocean simulation component
+	float OceanLevel;
+	FVector Normal, Velocity;
+	GetSnapshotForSampling()->Sample(Location, OceanLevel, Normal, Velocity);
+
+	return Velocity;
+}
+
+void AVaOceanStateActor::GetOceanState(const FVector& Location, float& OutLevel, FVector& OutNormal, FVector& OutVelocity) const
+{
+	GetSnapshotForSampling()->Sample(Location, OutLevel, OutNormal, OutVelocity);
+}
 
-	return FVector::UpVector;
+void AVaOceanStateActor::GetOceanStateBatch(const TArray<FVector>& Locations, TArray<float>& OutLevels, TArray<FVector>& OutNormals, TArray<FVector>& OutVelocities) const
+{
+	GetSnapshotForSampling()->SampleBatch(Locations, OutLevels, OutNormals, OutVelocities);
 }
 
 int32 AVaOceanStateActor::GetOceanWavesNum() const
@@ -97,12 +207,224 @@ int32 AVaOceanStateActor::GetOceanWavesNum() const
 	return 1;
 }
 
+
+//////////////////////////////////////////////////////////////////////////
+// Ocean region
+
+bool AVaOceanStateActor::GetRegionBounds(FBox2D& OutBounds) const
+{
+	if (bUnboundedRegion)
+	{
+		return false;
+	}
+
+	const FVector Location = GetActorLocation();
+	const FVector2D Center(Location.X, Location.Y);
+	OutBounds = FBox2D(Center - RegionExtent, Center + RegionExtent);
+
+	return true;
+}
+
+int32 AVaOceanStateActor::GetRegionPriority() const
+{
+	return RegionPriority;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Ocean clock
+
+float AVaOceanStateActor::GetOceanTime() const
+{
+	const UWorld* World = GetWorld();
+	if (World == NULL)
+	{
+		return OceanClock.BaseOceanTime;
+	}
+
+	return OceanClock.BaseOceanTime + (World->GetTimeSeconds() - LocalClockBaseTime) * OceanClock.TimeScale;
+}
+
+void AVaOceanStateActor::SetOceanTimeScale(float TimeScale)
+{
+	if (Role < ROLE_Authority)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Ocean time scale can be changed by server only"));
+		return;
+	}
+
+	// Keep current ocean time continuous
+	ResyncOceanClock();
+	OceanClock.TimeScale = TimeScale;
+}
+
+float AVaOceanStateActor::GetOceanTimeScale() const
+{
+	return OceanClock.TimeScale;
+}
+
+void AVaOceanStateActor::ResyncOceanClock()
+{
+	check(Role == ROLE_Authority);
+
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+
+	OceanClock.BaseOceanTime = GetOceanTime();
+	OceanClock.BaseServerTime = WorldTime;
+	LocalClockBaseTime = WorldTime;
+	LastClockSyncTime = WorldTime;
+}
+
+void AVaOceanStateActor::OnRep_OceanClock()
+{
+	const UWorld* World = GetWorld();
+	if (World == NULL)
+	{
+		return;
+	}
+
+	// Time base is sent right after server has made it, so it's as old as network delay.
+	// The first one (when we join) was made up to sync interval earlier, initial server time tells how much.
+	const float ClockAge = (NumClockUpdates == 0) ? FMath::Max(InitialServerTime - OceanClock.BaseServerTime, 0.0f) : 0.0f;
+	LocalClockBaseTime = World->GetTimeSeconds() - GetClockLatency() - ClockAge;
+	NumClockUpdates++;
+
+	UE_LOG(LogVaOcean, Verbose, TEXT("Ocean clock synced (%d): %f"), NumClockUpdates, GetOceanTime());
+}
+
+float AVaOceanStateActor::GetClockLatency() const
+{
+	APlayerController* PlayerController = GEngine->GetFirstLocalPlayerController(GetWorld());
+	if (PlayerController && PlayerController->PlayerState)
+	{
+		// Ping is round trip compressed to msec / 4
+		return PlayerController->PlayerState->Ping * 4.0f * 0.5f / 1000.0f;
+	}
+
+	return 0.0f;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Sea state
+
+void AVaOceanStateActor::SetSeaState(FVector2D WindDirection, float WindSpeed, float WaveAmplitude, float BlendTime)
+{
+	if (Role < ROLE_Authority)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Sea state can be changed by server only"));
+		return;
+	}
+
+	SeaState.WindDirection = WindDirection;
+	SeaState.WindSpeed = WindSpeed;
+	SeaState.WaveAmplitude = WaveAmplitude;
+	SeaState.BlendStartTime = GetOceanTime();
+	SeaState.BlendTime = FMath::Max(BlendTime, 0.0f);
+	SeaState.Revision++;
+
+	ApplySeaState();
+}
+
+void AVaOceanStateActor::OnRep_SeaState()
+{
+	ApplySeaState();
+}
+
+void AVaOceanStateActor::ApplySeaState()
+{
+	if (SeaState.Revision == 0)
+	{
+		return;
+	}
+
+	SpectrumConfig.WindDirection = SeaState.WindDirection;
+	SpectrumConfig.WindSpeed = SeaState.WindSpeed;
+	SpectrumConfig.WaveAmplitude = SeaState.WaveAmplitude;
+
+	// Blend is timed with ocean clock, so late joiners get the final state right away
+	if (OceanSimulator)
+	{
+		OceanSimulator->RetargetSpectrum(SpectrumConfig, SeaState.BlendStartTime, SeaState.BlendTime);
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Ocean snapshot
+
+FVaOceanSnapshotPtr AVaOceanStateActor::GetOceanSnapshot() const
+{
+	FScopeLock Lock(&SnapshotCriticalSection);
+	return CurrentSnapshot;
+}
+
+void AVaOceanStateActor::UpdateOceanSnapshot()
+{
+	FVaOceanSnapshot* Snapshot = new FVaOceanSnapshot();
+	BuildOceanSnapshot(*Snapshot);
+
+	// Readers keep their own references, so old snapshot lives until the last one is released
+	FVaOceanSnapshotPtr NewSnapshot = MakeShareable(Snapshot);
+	{
+		FScopeLock Lock(&SnapshotCriticalSection);
+		Exchange(CurrentSnapshot, NewSnapshot);
+	}
+}
+
+void AVaOceanStateActor::BuildOceanSnapshot(FVaOceanSnapshot& OutSnapshot) const
+{
+	OutSnapshot.FrameNumber = (uint32)GFrameCounter;
+	OutSnapshot.OceanLevel = GetGlobalOceanLevel();
+	OutSnapshot.Time = GetOceanTime();
+	OutSnapshot.TimeRate = OceanClock.TimeScale;
+
+	if (OceanSimulator && OceanSimulator->IsSimulationReady())
+	{
+		OceanSimulator->GetCascadeGrids(INDEX_NONE, OutSnapshot.CascadeGrids);
+
+		// Flat displacement needs no inverse lookup
+		if (SpectrumConfig.ChoppyScale > 0.0f)
+		{
+			OutSnapshot.CascadeInverseIterations = FMath::Clamp(SpectrumConfig.InverseDisplacementIterations, 0, 4);
+		}
+
+		for (int32 LODIndex = 0; LODIndex < OceanSimulator->GetNumPhysicsLODs(); LODIndex++)
+		{
+			FVaOceanPhysicsLOD& PhysicsLOD = *new(OutSnapshot.PhysicsLODs) FVaOceanPhysicsLOD();
+			PhysicsLOD.MinWaveLength = OceanSimulator->GetPhysicsLODWaveLength(LODIndex);
+			OceanSimulator->GetCascadeGrids(LODIndex, PhysicsLOD.CascadeGrids);
+		}
+	}
+	else if (OceanSimulator)
+	{
+		// Sparse sampling mode evaluates the strongest spectrum waves directly
+		OutSnapshot.WaveSet = OceanSimulator->GetSparseWaveSet();
+	}
+}
+
+FVaOceanSnapshotPtr AVaOceanStateActor::GetSnapshotForSampling() const
+{
+	FVaOceanSnapshotPtr Snapshot = GetOceanSnapshot();
+	if (Snapshot.IsValid())
+	{
+		return Snapshot;
+	}
+
+	FVaOceanSnapshot* TempSnapshot = new FVaOceanSnapshot();
+	BuildOceanSnapshot(*TempSnapshot);
+
+	return MakeShareable(TempSnapshot);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Parameters access (get/set)
 
 void AVaOceanStateActor::SetGlobalOceanLevel(float OceanLevel)
 {
 	GlobalOceanLevel = OceanLevel;
+
+	UpdateOceanSnapshot();
 }
 
 float AVaOceanStateActor::GetGlobalOceanLevel() const
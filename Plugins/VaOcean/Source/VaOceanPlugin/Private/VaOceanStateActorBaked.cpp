@@ -0,0 +1,115 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+AVaOceanStateActorBaked::AVaOceanStateActorBaked(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	AnimationFile = TEXT("VaOcean/BakedOcean.vaocean");
+	NumBakedFrames = 64;
+	BakedDimension = 128;
+
+	// Baked animation should loop
+	SpectrumConfig.LoopPeriod = 30.0f;
+
+#if WITH_EDITORONLY_DATA
+	bBakeAnimation = false;
+#endif // WITH_EDITORONLY_DATA
+}
+
+void AVaOceanStateActorBaked::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	LoadAnimation();
+}
+
+#if WITH_EDITOR
+void AVaOceanStateActorBaked::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName PropertyName = PropertyChangedEvent.Property ? PropertyChangedEvent.Property->GetFName() : NAME_None;
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(AVaOceanStateActorBaked, bBakeAnimation) && bBakeAnimation)
+	{
+		bBakeAnimation = false;
+		BakeAnimation();
+	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(AVaOceanStateActorBaked, AnimationFile))
+	{
+		LoadAnimation();
+	}
+}
+#endif // WITH_EDITOR
+
+
+//////////////////////////////////////////////////////////////////////////
+// Baked ocean model API
+
+bool AVaOceanStateActorBaked::IsAnimationLoaded() const
+{
+	return Animation.IsValid();
+}
+
+bool AVaOceanStateActorBaked::BakeAnimation()
+{
+	if (!FMath::IsPowerOfTwo(BakedDimension))
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Baked ocean dimension should be power of two"));
+		return false;
+	}
+
+	// Mapped file can't be overwritten
+	Animation.Reset();
+	UpdateOceanSnapshot();
+
+	FSpectrumData BakeConfig = SpectrumConfig;
+	BakeConfig.DispMapDimension = BakedDimension;
+
+	const FString FilePath = GetAnimationFilePath();
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+
+	const bool bBaked = FVaOceanBakedAnimation::Bake(BakeConfig, NumBakedFrames, FilePath);
+
+	return LoadAnimation() && bBaked;
+}
+
+bool AVaOceanStateActorBaked::LoadAnimation()
+{
+	// Snapshots can still reference the old animation, so new one is created each time
+	FVaOceanBakedAnimation* NewAnimation = new FVaOceanBakedAnimation();
+	if (NewAnimation->Open(GetAnimationFilePath()))
+	{
+		Animation = MakeShareable(NewAnimation);
+	}
+	else
+	{
+		delete NewAnimation;
+		Animation.Reset();
+	}
+
+	UpdateOceanSnapshot();
+
+	return Animation.IsValid();
+}
+
+FString AVaOceanStateActorBaked::GetAnimationFilePath() const
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::GameContentDir() / AnimationFile);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Ocean snapshot
+
+void AVaOceanStateActorBaked::BuildOceanSnapshot(FVaOceanSnapshot& OutSnapshot) const
+{
+	Super::BuildOceanSnapshot(OutSnapshot);
+
+	if (Animation.IsValid())
+	{
+		// Only frame selection is done each tick, sampling reads two frames directly from mapped file
+		OutSnapshot.BakedAnimation = Animation;
+		Animation->GetFramesAtTime(OutSnapshot.Time, OutSnapshot.BakedFrameA, OutSnapshot.BakedFrameB, OutSnapshot.BakedFrameAlpha);
+	}
+}
@@ -0,0 +1,190 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#include "VaOceanPluginPrivatePCH.h"
+
+AVaOceanStateActorGerstner::AVaOceanStateActorGerstner(const class FPostConstructInitializeProperties& PCIP)
+	: Super(PCIP)
+{
+	bGenerateWavesFromSpectrum = true;
+	NumGeneratedWaves = 16;
+	InverseDisplacementIterations = 2;
+
+	WaveBlendStartTime = 0.0f;
+	WaveBlendTime = 0.0f;
+}
+
+void AVaOceanStateActorGerstner::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	if (bGenerateWavesFromSpectrum)
+	{
+		GenerateWavesFromSpectrum();
+	}
+	else
+	{
+		UpdateWaveCache();
+	}
+}
+
+void AVaOceanStateActorGerstner::Tick(float DeltaSeconds)
+{
+	// Waves should be mixed before the snapshot is published
+	if (BlendSourceWaveSet.IsValid())
+	{
+		UpdateWaveBlend();
+	}
+
+	Super::Tick(DeltaSeconds);
+}
+
+#if WITH_EDITOR
+void AVaOceanStateActorGerstner::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (bGenerateWavesFromSpectrum)
+	{
+		GenerateWavesFromSpectrum();
+	}
+	else
+	{
+		UpdateWaveCache();
+	}
+}
+#endif // WITH_EDITOR
+
+
+//////////////////////////////////////////////////////////////////////////
+// Ocean state API
+
+int32 AVaOceanStateActorGerstner::GetOceanWavesNum() const
+{
+	return Waves.Num();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Gerstner ocean model API
+
+void AVaOceanStateActorGerstner::SetWaves(const TArray<FGerstnerWave>& InWaves)
+{
+	Waves = InWaves;
+
+	// Explicit waves replace the current ones right away
+	BlendSourceWaveSet.Reset();
+	UpdateWaveCache();
+}
+
+const TArray<FGerstnerWave>& AVaOceanStateActorGerstner::GetWaves() const
+{
+	return Waves;
+}
+
+void AVaOceanStateActorGerstner::GenerateWavesFromSpectrum()
+{
+	const FVector2D WindDir = SpectrumConfig.WindDirection.SafeNormal();
+	const float WindAngle = FMath::Atan2(WindDir.Y, WindDir.X);
+	const float A = VaOceanPhillipsAmplitude(SpectrumConfig);
+
+	// Waves are spread around the wind, opposite ones are mostly damped by spectrum anyway
+	const float AngularSpread = PI / 3.0f;
+
+	// FFT version has one wave per grid cell of this size, so amplitudes should be normalized by it
+	const float GridDeltaK = 2.0f * PI / SpectrumConfig.PatchLength;
+
+	// Wave numbers are log-spaced from the whole patch to its 1/64 part
+	const float KMin = GridDeltaK;
+	const float KMax = GridDeltaK * 64.0f;
+	const float LogStep = FMath::Loge(KMax / KMin) / NumGeneratedWaves;
+
+	FRandomStream RandomStream(SpectrumConfig.RandomSeed);
+
+	Waves.Empty(NumGeneratedWaves);
+	for (int32 i = 0; i < NumGeneratedWaves; i++)
+	{
+		const float K = KMin * FMath::Exp((i + 0.5f) * LogStep);
+		const float DeltaK = K * LogStep;
+
+		const float Angle = WindAngle + (RandomStream.FRand() * 2.0f - 1.0f) * AngularSpread;
+		const FVector2D Direction(FMath::Cos(Angle), FMath::Sin(Angle));
+
+		// Each wave represents the energy of the whole spectrum band: variance of the sum should be the same
+		const float BandArea = K * DeltaK * 2.0f * AngularSpread;
+		const float Energy = VaOceanPhillips(Direction * K, WindDir, SpectrumConfig.WindSpeed, A, SpectrumConfig.WindDependency);
+
+		FGerstnerWave Wave;
+		Wave.Direction = Direction;
+		Wave.WaveLength = 2.0f * PI / K;
+		Wave.Amplitude = 2.0f * FMath::Sqrt(Energy * BandArea) / GridDeltaK;
+		Wave.Steepness = FMath::Clamp(SpectrumConfig.ChoppyScale, 0.0f, 1.0f);
+		Wave.Phase = RandomStream.FRand() * 2.0f * PI;
+
+		Waves.Add(Wave);
+	}
+
+	UpdateWaveCache();
+}
+
+void AVaOceanStateActorGerstner::UpdateWaveCache()
+{
+	// Snapshots can still reference the old set, so new one is created each time
+	FVaOceanWaveSet* NewWaveSet = new FVaOceanWaveSet();
+	NewWaveSet->Init(Waves, InverseDisplacementIterations, SpectrumConfig.TimeScale);
+
+	TargetWaveSet = MakeShareable(NewWaveSet);
+	UpdateWaveBlend();
+
+	UpdateOceanSnapshot();
+}
+
+float AVaOceanStateActorGerstner::GetWaveBlendAlpha() const
+{
+	// Blend is timed with ocean clock, so all machines show the same sea state
+	return (WaveBlendTime > KINDA_SMALL_NUMBER) ? FMath::Clamp((GetOceanTime() - WaveBlendStartTime) / WaveBlendTime, 0.0f, 1.0f) : 1.0f;
+}
+
+void AVaOceanStateActorGerstner::UpdateWaveBlend()
+{
+	const float Alpha = GetWaveBlendAlpha();
+
+	if (!BlendSourceWaveSet.IsValid() || !TargetWaveSet.IsValid() || Alpha >= 1.0f)
+	{
+		BlendSourceWaveSet.Reset();
+		WaveSet = TargetWaveSet;
+		return;
+	}
+
+	// Snapshots can still reference the old set, so new one is created each time
+	FVaOceanWaveSet* NewWaveSet = new FVaOceanWaveSet();
+	NewWaveSet->InitBlend(*BlendSourceWaveSet, *TargetWaveSet, Alpha);
+
+	WaveSet = MakeShareable(NewWaveSet);
+}
+
+void AVaOceanStateActorGerstner::ApplySeaState()
+{
+	Super::ApplySeaState();
+
+	// Analytic waves are cheap to rebuild, so they just follow the new wind
+	if (SeaState.Revision > 0 && bGenerateWavesFromSpectrum)
+	{
+		// Blend of blends would grow with each change, so the stronger side of unfinished blend is faded out
+		if (!BlendSourceWaveSet.IsValid() || GetWaveBlendAlpha() >= 0.5f)
+		{
+			BlendSourceWaveSet = TargetWaveSet;
+		}
+
+		WaveBlendStartTime = SeaState.BlendStartTime;
+		WaveBlendTime = SeaState.BlendTime;
+
+		GenerateWavesFromSpectrum();
+	}
+}
+
+void AVaOceanStateActorGerstner::BuildOceanSnapshot(FVaOceanSnapshot& OutSnapshot) const
+{
+	Super::BuildOceanSnapshot(OutSnapshot);
+
+	OutSnapshot.WaveSet = WaveSet;
+}
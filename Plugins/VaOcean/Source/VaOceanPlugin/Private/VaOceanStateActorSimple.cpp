@@ -17,20 +17,23 @@ AVaOceanStateActorSimple::AVaOceanStateActorSimple(const class FPostConstructIni
 	WaterHeight = 100.0f;
 
 	WaveHeightPannerTime = 0.0f;
+	bPannerUsesOceanClock = true;
+
+	HeightMapSizeX = 0;
+	HeightMapSizeY = 0;
+	bRawDataReady = false;
+
+	UpdateSamplerParams();
 }
 
 void AVaOceanStateActorSimple::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
 
-	// Load raw data with first function call
+	// Heightmap is baked in editor, so there is nothing to decompress here
 	if (OceanHeightMap)
 	{
-#if WITH_EDITORONLY_DATA
-		bRawDataReady = OceanHeightMap->Source.GetMipData(HeightMapRawData, 0);
-#else
-		bRawDataReady = false;
-#endif
+		bRawDataReady = (FMath::IsPowerOfTwo(HeightMapSizeX) && FMath::IsPowerOfTwo(HeightMapSizeY) && HeightMapData.Num() == HeightMapSizeX * HeightMapSizeY);
 		UE_LOG(LogVaOcean, Log, TEXT("Ocean heighmap load status: %d"), (int)bRawDataReady);
 	}
 	else
@@ -38,137 +41,190 @@ void AVaOceanStateActorSimple::PostInitializeComponents()
 		UE_LOG(LogVaOcean, Warning, TEXT("Heightmap is not set for ocean state!"));
 		bRawDataReady = false;
 	}
-}
 
+	UpdateHeightMapGrid();
+	UpdateSamplerParams();
+	UpdateOceanSnapshot();
+}
 
-//////////////////////////////////////////////////////////////////////////
-// Ocean state API
-
-float AVaOceanStateActorSimple::GetOceanLevelAtLocation(FVector& Location) const
+void AVaOceanStateActorSimple::PostLoad()
 {
-	// Check that we've set a texture
-	if (!OceanHeightMap)
-	{
-		return GetGlobalOceanLevel() + WaterHeight;
-	}
+	Super::PostLoad();
 
-#if WITH_EDITORONLY_DATA
-	check(OceanHeightMap->Source.IsValid());
-
-	// Check we have a raw data loaded
-	if (!bRawDataReady)
+#if WITH_EDITOR
+	// Actors saved before baking was introduced have no heightmap data yet
+	if (OceanHeightMap && HeightMapData.Num() == 0)
 	{
-		// UE_LOG(LogVaOcean, Warning, TEXT("Can't load raw data of ocean heightmap!"));
-		return 0.0f;
+		BakeHeightMap();
 	}
+#endif // WITH_EDITOR
+}
 
-	//
-	// SimpleOcean shader algorythm
-	//
-
-	// World UV location
-	float WorldUVx = Location.X / WorldPositionDivider / WaveUVDivider;
-	float WorldUVy = Location.Y / WorldPositionDivider / WaveUVDivider;
+#if WITH_EDITOR
+void AVaOceanStateActorSimple::PreSave()
+{
+	Super::PreSave();
 
-	// Apply panner
-	WorldUVx += WaveHeightPannerX * WaveHeightPannerTime;
-	WorldUVy += WaveHeightPannerY * WaveHeightPannerTime;
+	// Always keep baked data in sync with source art before saving or cooking
+	BakeHeightMap();
+}
 
-	// Get heightmap color
-	const FLinearColor PixelColor = FLinearColor(GetHeighMapPixelColor(WorldUVx, WorldUVy));
+void AVaOceanStateActorSimple::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
 
-	// Calculate wave height
-	float OceanLevel = PixelColor.A * WaveHeight - WaterHeight;
+	const FName PropertyName = PropertyChangedEvent.Property ? PropertyChangedEvent.Property->GetFName() : NAME_None;
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(AVaOceanStateActorSimple, OceanHeightMap))
+	{
+		BakeHeightMap();
+		bRawDataReady = (FMath::IsPowerOfTwo(HeightMapSizeX) && FMath::IsPowerOfTwo(HeightMapSizeY) && HeightMapData.Num() == HeightMapSizeX * HeightMapSizeY);
+	}
 
-	return OceanLevel + GlobalOceanLevel;
-#else
-	return GetGlobalOceanLevel() + WaterHeight;
-#endif
+	UpdateHeightMapGrid();
+	UpdateSamplerParams();
+	UpdateOceanSnapshot();
 }
 
-FLinearColor AVaOceanStateActorSimple::GetOceanSurfaceNormal(FVector& Location) const
+void AVaOceanStateActorSimple::BakeHeightMap()
 {
-	// Check that we've set a texture
-	if (!OceanHeightMap)
+	HeightMapData.Empty();
+	HeightMapSizeX = 0;
+	HeightMapSizeY = 0;
+
+	if (!OceanHeightMap || !OceanHeightMap->Source.IsValid())
 	{
-		return FLinearColor::Blue;
+		return;
 	}
 
-#if WITH_EDITORONLY_DATA
-	check(OceanHeightMap->Source.IsValid());
+	if (OceanHeightMap->Source.GetFormat() != TSF_BGRA8)
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Ocean heightmap %s should be BGRA8 to be baked"), *OceanHeightMap->GetName());
+		return;
+	}
 
-	// Check we have a raw data loaded
-	if (!bRawDataReady)
+	TArray<uint8> RawData;
+	if (!OceanHeightMap->Source.GetMipData(RawData, 0))
 	{
-		// UE_LOG(LogVaOcean, Warning, TEXT("Can't load raw data of ocean heightmap!"));
-		return FLinearColor::Black;
+		UE_LOG(LogVaOcean, Warning, TEXT("Can't load raw data of ocean heightmap %s"), *OceanHeightMap->GetName());
+		return;
 	}
 
-	//
-	// SKOcean shader algorythm
-	//
+	const int32 Width = OceanHeightMap->Source.GetSizeX();
+	const int32 Height = OceanHeightMap->Source.GetSizeY();
 
-	// World UV location
-	float WorldUVx = Location.X / WorldPositionDivider / WaveUVDivider;
-	float WorldUVy = Location.Y / WorldPositionDivider / WaveUVDivider;
+	// Sampler wraps coords with bit masks
+	if (!FMath::IsPowerOfTwo(Width) || !FMath::IsPowerOfTwo(Height))
+	{
+		UE_LOG(LogVaOcean, Warning, TEXT("Ocean heightmap %s should have power of two dimensions to be baked"), *OceanHeightMap->GetName());
+		return;
+	}
 
-	// Apply panner
-	WorldUVx += WaveHeightPannerX * WaveHeightPannerTime;
-	WorldUVy += WaveHeightPannerY * WaveHeightPannerTime;
+	check(RawData.Num() == Width * Height * sizeof(FColor));
 
-	// Get heightmap color
-	return FLinearColor(GetHeighMapPixelColor(WorldUVx, WorldUVy));
-#else
-	return FLinearColor::Blue;
-#endif
-}
+	// Keep alpha channel only: it's the only one used for wave height
+	const FColor* SrcPtr = (const FColor*)RawData.GetTypedData();
+	HeightMapData.AddUninitialized(Width * Height);
+	for (int32 i = 0; i < Width * Height; i++)
+	{
+		HeightMapData[i] = SrcPtr[i].A;
+	}
 
-FVector AVaOceanStateActorSimple::GetOceanWaveVelocity(FVector& Location) const
-{
-	FVector WaveVelocity = FVector(WaveHeightPannerX, WaveHeightPannerY, 0.0f);
+	HeightMapSizeX = Width;
+	HeightMapSizeY = Height;
+}
+#endif // WITH_EDITOR
 
-	// Scale to the world size (in m/sec!)
-	WaveVelocity *= WorldPositionDivider * WaveUVDivider / 100.0f;
 
-	return WaveVelocity;
-}
+//////////////////////////////////////////////////////////////////////////
+// Ocean state API
 
 int32 AVaOceanStateActorSimple::GetOceanWavesNum() const
 {
 	return HeightMapWaves;
 }
 
-FColor AVaOceanStateActorSimple::GetHeighMapPixelColor(float U, float V) const
+void AVaOceanStateActorSimple::BuildOceanSnapshot(FVaOceanSnapshot& OutSnapshot) const
 {
-	// Check we have a raw data loaded
-	if (!bRawDataReady)
+	Super::BuildOceanSnapshot(OutSnapshot);
+
+	// Panner shifts sampling coords forward, so the wave pattern itself travels backwards
+	const float TileSize = WorldPositionDivider * WaveUVDivider;
+	OutSnapshot.GridPhaseVelocity = FVector(-WaveHeightPannerX, -WaveHeightPannerY, 0.0f) * TileSize;
+	OutSnapshot.GridWaveNumber = 2.0f * PI * HeightMapWaves / TileSize;
+
+	if (HeightMapGrid.IsValid())
+	{
+		OutSnapshot.Grid = HeightMapGrid;
+
+		if (bPannerUsesOceanClock)
+		{
+			GetPannerTexels(OutSnapshot.Time, OutSnapshot.GridOffsetX, OutSnapshot.GridOffsetY);
+		}
+		else
+		{
+			OutSnapshot.GridOffsetX = PannerTexelsX;
+			OutSnapshot.GridOffsetY = PannerTexelsY;
+		}
+	}
+	else
 	{
-		//UE_LOG(LogVaOcean, Warning, TEXT("Ocean heightmap raw data is not loaded! Pixel is empty."));
-		return FColor::Black;
+		// Flat water without heightmap
+		OutSnapshot.OceanLevel += WaterHeight;
 	}
+}
 
-#if WITH_EDITORONLY_DATA
-	// We are using the source art so grab the original width/height
-	const int32 Width = OceanHeightMap->Source.GetSizeX();
-	const int32 Height = OceanHeightMap->Source.GetSizeY();
-	const bool bUseSRGB = OceanHeightMap->SRGB;
+void AVaOceanStateActorSimple::UpdateHeightMapGrid()
+{
+	if (!OceanHeightMap || !bRawDataReady)
+	{
+		HeightMapGrid.Reset();
+		return;
+	}
 
-	check(Width > 0 && Height > 0 && HeightMapRawData.Num() > 0);
+	// Snapshots can still reference the old grid, so new one is created each time
+	FVaOceanGrid* Grid = new FVaOceanGrid();
+	Grid->Init(HeightMapSizeX, HeightMapSizeY, WorldPositionDivider * WaveUVDivider, WorldPositionDivider * WaveUVDivider);
 
-	// Normalize UV first
-	const float NormalizedU = U > 0 ? FMath::Fractional(U) : 1.0 + FMath::Fractional(U);
-	const float NormalizedV = V > 0 ? FMath::Fractional(V) : 1.0 + FMath::Fractional(V);
+	if (HeightMapData.Num() > 0 && GetWorld() && GetWorld()->IsGameWorld())
+	{
+		// Game doesn't need baked property anymore, so heightmap is kept by the grid only
+		Exchange(Grid->HeightBytes, HeightMapData);
+	}
+	else if (HeightMapData.Num() > 0)
+	{
+		// Editor world keeps the property to be saved
+		Grid->HeightBytes = HeightMapData;
+	}
+	else if (HeightMapGrid.IsValid())
+	{
+		// Bytes were already moved to the previous grid
+		Grid->HeightBytes = HeightMapGrid->HeightBytes;
+	}
+
+	Grid->HeightBytesScale = WaveHeight / 255.0f;
+	Grid->HeightBytesBias = -WaterHeight;
+
+	// Waves oscillate around average height
+	float HeightSum = 0.0f;
+	for (int32 Index = 0; Index < Grid->HeightBytes.Num(); Index++)
+	{
+		HeightSum += Grid->GetHeight(Index);
+	}
+	Grid->MeanHeight = HeightSum / FMath::Max(Grid->HeightBytes.Num(), 1);
 
-	const int PixelX = NormalizedU * (Width-1) + 1;
-	const int PixelY = NormalizedV * (Height-1) + 1;
+	HeightMapGrid = MakeShareable(Grid);
+}
 
-	// Get color from
-	const FColor* SrcPtr = &((FColor*)(HeightMapRawData.GetTypedData()))[(PixelY - 1) * Width + PixelX - 1];
+void AVaOceanStateActorSimple::UpdateSamplerParams()
+{
+	GetPannerTexels(WaveHeightPannerTime, PannerTexelsX, PannerTexelsY);
+}
 
-	return *SrcPtr;
-#else
-	return FColor::Black;
-#endif
+void AVaOceanStateActorSimple::GetPannerTexels(float PannerTime, float& OutTexelsX, float& OutTexelsY) const
+{
+	// Keep panner offset inside one tile to save float precision, GPU samples texel centers so shift by half texel
+	OutTexelsX = FMath::Fmod(WaveHeightPannerX * PannerTime, 1.0f) * HeightMapSizeX - 0.5f;
+	OutTexelsY = FMath::Fmod(WaveHeightPannerY * PannerTime, 1.0f) * HeightMapSizeY - 0.5f;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -207,4 +263,7 @@ float AVaOceanStateActorSimple::GetWaterHeight() const
 void AVaOceanStateActorSimple::SetWaveHeightPannerTime(float Time)
 {
 	WaveHeightPannerTime = Time;
+
+	UpdateSamplerParams();
+	UpdateOceanSnapshot();
 }
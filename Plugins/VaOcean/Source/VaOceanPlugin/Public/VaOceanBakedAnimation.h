@@ -0,0 +1,118 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+/** Quantized surface texel of baked animation frame */
+struct FVaOceanBakedTexel
+{
+	/** Displacement (dx, dy, dz), multiplied by frame displacement scale */
+	int16 Displacement[3];
+
+	/** Height gradient (dz/dx, dz/dy), multiplied by frame gradient scale */
+	int16 Gradient[2];
+
+	/** Keeps texel 4-byte aligned */
+	int16 Padding;
+};
+
+/** Dequantization scales of one baked frame */
+struct FVaOceanBakedFrameScale
+{
+	float DisplacementScale;
+	float GradientScale;
+};
+
+/**
+ * Looping ocean animation baked from FFT simulation into a binary file.
+ * File is memory-mapped read-only, so all processes on the same host share one copy of it.
+ *
+ * File layout: header, frame scales, frames of SizeX * SizeY texels each.
+ */
+struct VAOCEANPLUGIN_API FVaOceanBakedAnimation
+{
+	/** File header */
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+
+		/** Grid dimensions, both should be power of two */
+		int32 SizeX;
+		int32 SizeY;
+
+		/** Frames in one loop */
+		int32 NumFrames;
+
+		/** Loop duration [ocean sec] */
+		float LoopPeriod;
+
+		/** World size of the tile */
+		float PatchLength;
+
+		/** Offset of the first texel from file start */
+		uint32 TexelDataOffset;
+	};
+
+	static const uint32 FileMagic = 0x41424F56;	// "VOBA"
+	static const uint32 FileVersion = 1;
+
+	FVaOceanBakedAnimation();
+	~FVaOceanBakedAnimation();
+
+	/** Map baked file into memory and validate its header */
+	bool Open(const FString& Filename);
+
+	/** Is file mapped and valid */
+	bool IsValid() const;
+
+	/** Loop properties */
+	int32 GetNumFrames() const;
+	float GetLoopPeriod() const;
+	float GetFrameDuration() const;
+
+	/** Two frames to be blended for desired ocean time */
+	void GetFramesAtTime(float Time, int32& OutFrameA, int32& OutFrameB, float& OutAlpha) const;
+
+	/** Bilinear filtered height, gradient and velocity [uu per ocean sec] at world XY blended between two frames */
+	void Sample(int32 FrameA, int32 FrameB, float Alpha, float X, float Y, float& OutHeight, FVector2D& OutGradient, FVector& OutVelocity) const;
+
+	/**
+	 * Run FFT simulation over one loop period and write it to a file.
+	 * Spectrum should have LoopPeriod set, so the last frame blends into the first one.
+	 */
+	static bool Bake(const FSpectrumData& SpectrumConfig, int32 NumFrames, const FString& Filename);
+
+private:
+	/** Dequantized displacement of the texel */
+	FORCEINLINE FVector GetDisplacement(int32 Frame, int32 Index) const
+	{
+		const FVaOceanBakedTexel& Texel = Texels[Frame * TexelsPerFrame + Index];
+		const float Scale = FrameScales[Frame].DisplacementScale;
+		return FVector(Texel.Displacement[0] * Scale, Texel.Displacement[1] * Scale, Texel.Displacement[2] * Scale);
+	}
+
+	/** Dequantized gradient of the texel */
+	FORCEINLINE FVector2D GetGradient(int32 Frame, int32 Index) const
+	{
+		const FVaOceanBakedTexel& Texel = Texels[Frame * TexelsPerFrame + Index];
+		const float Scale = FrameScales[Frame].GradientScale;
+		return FVector2D(Texel.Gradient[0] * Scale, Texel.Gradient[1] * Scale);
+	}
+
+	/** Unmap file */
+	void Close();
+
+	/** Mapped file view */
+	FVaOceanMappedFile File;
+
+	/** Pointers into mapped data */
+	const FHeader* Header;
+	const FVaOceanBakedFrameScale* FrameScales;
+	const FVaOceanBakedTexel* Texels;
+
+	int32 TexelsPerFrame;
+	float TexelsPerUnitX;
+	float TexelsPerUnitY;
+};
+
+typedef TSharedPtr<const FVaOceanBakedAnimation, ESPMode::ThreadSafe> FVaOceanBakedAnimationPtr;
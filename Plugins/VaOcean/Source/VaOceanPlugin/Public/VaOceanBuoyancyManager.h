@@ -0,0 +1,204 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+class UVaOceanBuoyancyComponent;
+class FVaOceanBuoyancyManager;
+class FVaOceanHullMesh;
+class FVaOceanHydrostatics;
+
+/** How much work buoyancy of a body takes, from the most precise one */
+namespace EVaOceanBuoyancyLOD
+{
+	enum Type
+	{
+		/** Tension dots, hull or hydrostatic tables */
+		Full,
+
+		/** Heave, pitch and roll springs to the surface at hull origin */
+		SinglePoint,
+
+		/** No physics, ship rides the surface */
+		Kinematic,
+	};
+}
+
+/** Tick of buoyancy manager, runs after oceans have published their snapshots */
+struct FVaOceanBuoyancyTickFunction : public FTickFunction
+{
+	/** Manager to be ticked */
+	FVaOceanBuoyancyManager* Manager;
+
+	FVaOceanBuoyancyTickFunction();
+
+	// Begin FTickFunction interface
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	// End FTickFunction interface
+};
+
+/**
+ * World-level wave reaction of all floating bodies. Tension dots of registered buoyancy components
+ * are gathered into flat arrays on game thread, bodies are evaluated in parallel by task graph workers,
+ * then accumulated forces are applied in one game thread sweep.
+ */
+class VAOCEANPLUGIN_API FVaOceanBuoyancyManager
+{
+public:
+	/** Manager of desired world, created on demand */
+	static FVaOceanBuoyancyManager& Get(UWorld* World);
+
+	~FVaOceanBuoyancyManager();
+
+	/** Start simulating body */
+	void Register(UVaOceanBuoyancyComponent* Body);
+
+	/** Stop simulating body */
+	void Unregister(UVaOceanBuoyancyComponent* Body);
+
+	/** Number of registered bodies */
+	int32 GetNumBodies() const;
+
+	/** Simulate all bodies (is called by tick function) */
+	void Tick(float DeltaTime);
+
+private:
+	FVaOceanBuoyancyManager(UWorld* InWorld);
+
+	/** Frame data of one body */
+	struct FBodyState
+	{
+		UVaOceanBuoyancyComponent* Body;
+
+		/** Buoyancy model picked for this frame */
+		EVaOceanBuoyancyLOD::Type LOD;
+
+		/** Ocean to sample, invalid if body is out of any ocean */
+		FVaOceanSnapshotPtr Snapshot;
+		int32 MaxCascades;
+		int32 PhysicsLOD;
+
+		/** Ocean level used without snapshot */
+		float DefaultOceanLevel;
+
+		/** Hull of picked LOD, dots are its vertices then. NULL means tension dots. */
+		const FVaOceanHullMesh* Hull;
+
+		/** Hydrostatic tables, dots are water plane points then. Have priority over hull. */
+		const FVaOceanHydrostatics* Hydrostatics;
+
+		/** Hull pressure growth per unit of depth (density * gravity) */
+		float WaterPressure;
+
+		/** Clipped hull triangles are written here */
+		int32 FirstScratch;
+
+		/** Range of body dots, padded one is a multiple of SIMD width */
+		int32 FirstDot;
+		int32 NumDots;
+		int32 NumPaddedDots;
+
+		/** Body transform: location and rotated unit axes */
+		FVector Location;
+		FVector AxisX;
+		FVector AxisY;
+		FVector AxisZ;
+
+		/** Body rotation and physics velocities (angular is in rad/s) */
+		FQuat Rotation;
+		FVector LinearVelocity;
+		FVector AngularVelocity;
+
+		/** Altitude of body origin above mean ocean level that coarse LODs keep, invalid until it's measured */
+		float RestAltitude;
+		bool bRestAltitudeValid;
+
+		/** World center of mass, torque of dot forces is taken around it */
+		FVector CenterOfMass;
+
+		/** Mass * scale * DeltaTime */
+		float ForceScale;
+
+		/** Uniform scale of hull tables */
+		float Scale;
+
+		/** Evaluation result: sum of dot forces and their torque */
+		FVector Force;
+		FVector Torque;
+
+		/** Evaluation result of hull buoyancy */
+		float SubmergedVolume;
+		FVector CenterOfBuoyancy;
+		float WaterplaneArea;
+
+		/** Evaluation result: mean ocean level at body dots */
+		float MeanOceanLevel;
+
+		/** Evaluation result of single point model, velocity changes (angular is in deg/s) */
+		FVector DeltaLinearVelocity;
+		FVector DeltaAngularVelocity;
+
+		/** Evaluation result of kinematic model: new transform and whether sea is too rough to ride it */
+		FVector KinematicLocation;
+		FQuat KinematicRotation;
+		bool bDisturbed;
+	};
+
+	/** Collect bodies and their dots into frame buffers (game thread) */
+	void GatherBodies(float DeltaTime);
+
+	/** Transform dots of body, sample ocean at them and accumulate forces. Touches only body's own data, so bodies are evaluated in parallel. */
+	void EvaluateBody(int32 BodyIndex);
+
+	/** Push accumulated forces to physics (game thread) */
+	void ApplyForces(float DeltaTime);
+
+	/** Distance from location to the closest viewer, zero if there are no viewers */
+	float GetViewDistance(const FVector& Location) const;
+
+	/** Bodies evaluated by one task at least */
+	static const int32 MinBodiesPerTask = 2;
+
+	/** Make tick wait for desired ocean */
+	void AddOceanPrerequisite(AVaOceanStateActor* OceanStateActor);
+
+	/** World of the manager */
+	TWeakObjectPtr<UWorld> World;
+
+	/** Registered bodies */
+	TArray<TWeakObjectPtr<UVaOceanBuoyancyComponent> > Bodies;
+
+	/** Oceans tick function already waits for */
+	TArray<TWeakObjectPtr<AVaOceanStateActor> > PrerequisiteOceans;
+
+	FVaOceanBuoyancyTickFunction TickFunction;
+
+	/** Delta time of current frame, read by workers */
+	float FrameDeltaTime;
+
+	/** Gravity of current frame (positive), read by workers */
+	float FrameGravity;
+
+	/** Frame buffers, kept between frames to avoid allocations */
+	TArray<FBodyState> BodyStates;
+
+	/** The only dot of coarse LODs: hull origin */
+	TArray<FVector> OriginDots;
+
+	/** Viewers of this frame, hull and buoyancy LODs are picked by them */
+	TArray<FVector> ViewLocations;
+
+	/** Body space tension dots (center of mass offset included) or scaled hull vertices */
+	TArray<float> DotLocalX;
+	TArray<float> DotLocalY;
+	TArray<float> DotLocalZ;
+
+	/** World space tension dots and ocean state at them */
+	TArray<FVector> DotWorld;
+	TArray<float> DotOceanLevel;
+	TArray<FVector> DotSurfaceNormal;
+	TArray<FVector> DotWaveVelocity;
+
+	/** Clipped hull triangles of all bodies */
+	TArray<float> HullScratch;
+};
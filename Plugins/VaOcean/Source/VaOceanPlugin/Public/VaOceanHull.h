@@ -0,0 +1,73 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+/** Hydrostatic forces of the submerged part of hull */
+struct FVaOceanHullForces
+{
+	/** Sum of pressure forces and their torque around center of mass */
+	FVector Force;
+	FVector Torque;
+
+	/** Displaced water volume [uu^3] */
+	float SubmergedVolume;
+
+	/** Centroid of displaced water, valid when volume is positive */
+	FVector CenterOfBuoyancy;
+
+	FVaOceanHullForces();
+};
+
+/**
+ * Closed triangle mesh of the hull. Triangles are clipped by water surface sampled at hull vertices,
+ * then hydrostatic pressure is integrated over the submerged ones four triangles at once.
+ */
+class VAOCEANPLUGIN_API FVaOceanHullMesh
+{
+public:
+	FVaOceanHullMesh();
+
+	/** Take triangles of static mesh LOD 0, vertices split by UV seams are welded. Returns false if mesh is empty. */
+	bool InitFromStaticMesh(UStaticMesh* Mesh);
+
+	/** Is there anything to float */
+	bool IsValid() const;
+
+	/** Welded vertices in component space, ocean is sampled at them */
+	const TArray<FVector>& GetVertices() const;
+
+	int32 GetNumTriangles() const;
+
+	/** Floats of scratch memory ComputeForces() needs */
+	int32 GetScratchSize() const;
+
+	/**
+	 * Clip triangles by water and integrate pressure over submerged part. Can be called from any thread.
+	 *
+	 * @param WorldVertices		Hull vertices in world space (same order as GetVertices())
+	 * @param Depths			Depth of each vertex below ocean surface, negative above it
+	 * @param CenterOfMass		World point torque is taken around
+	 * @param WaterPressure		Pressure growth per unit of depth (density * gravity)
+	 * @param Scratch			GetScratchSize() floats for clipped triangles
+	 */
+	void ComputeForces(const FVector* WorldVertices, const float* Depths, const FVector& CenterOfMass, float WaterPressure, float* Scratch, FVaOceanHullForces& OutForces) const;
+
+private:
+	/** Streams of clipped triangles in scratch memory: three vertices and their depths */
+	enum EScratchStream
+	{
+		SS_X0, SS_Y0, SS_Z0,
+		SS_X1, SS_Y1, SS_Z1,
+		SS_X2, SS_Y2, SS_Z2,
+		SS_D0, SS_D1, SS_D2,
+		SS_Num
+	};
+
+	/** Each triangle gives two submerged ones at most, padded to SIMD width */
+	int32 GetScratchCapacity() const;
+
+	TArray<FVector> Vertices;
+
+	/** Three per triangle, ordered so cross product of edges points out of hull */
+	TArray<int32> Indices;
+};
@@ -0,0 +1,78 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+/** Hydrostatic properties of hull at one water plane, hull space */
+struct FVaOceanHydrostaticSample
+{
+	/** Displaced water volume [uu^3] */
+	float Volume;
+
+	/** Centroid of displaced water, hull origin if nothing is submerged */
+	FVector CenterOfBuoyancy;
+
+	/** Area of hull section by water plane [uu^2] */
+	float WaterplaneArea;
+
+	FVaOceanHydrostaticSample();
+};
+
+/**
+ * Hull integrated against flat water planes once, tabulated by draft, heel and trim.
+ * Buoyancy of the hull in calm or moderate sea is then one trilinear lookup against mean water plane.
+ *
+ * Water plane in hull space is z = Draft + tan(Trim) * x + tan(Heel) * y.
+ */
+class VAOCEANPLUGIN_API FVaOceanHydrostatics
+{
+public:
+	FVaOceanHydrostatics();
+
+	/** Tables of desired mesh, they are baked on first request and shared by all hulls of the mesh. Game thread only. */
+	static TSharedPtr<const FVaOceanHydrostatics, ESPMode::ThreadSafe> FindOrBake(UStaticMesh* Mesh, const FVaOceanHullMesh& Hull);
+
+	/** Integrate hull over the table grid */
+	void Bake(const FVaOceanHullMesh& Hull);
+
+	/** Are tables ready to be used */
+	bool IsValid() const;
+
+	/** Trilinear lookup, values out of table range are clamped. Angles are in radians. */
+	FVaOceanHydrostaticSample Lookup(float Draft, float Heel, float Trim) const;
+
+	/** Hull space points where ocean is sampled to fit mean water plane: center, bow, stern and both sides */
+	const TArray<FVector>& GetWaterPlanePoints() const;
+
+	/** Table resolution */
+	static const int32 NumDrafts = 24;
+	static const int32 NumHeels = 25;
+	static const int32 NumTrims = 13;
+
+	/** Table range of angles, [-Max, Max] */
+	static const float MaxHeel;
+	static const float MaxTrim;
+
+private:
+	/** Volume moment is tabulated instead of the centroid, so it's interpolated correctly near zero volume */
+	struct FCell
+	{
+		float Volume;
+		FVector VolumeMoment;
+		float WaterplaneArea;
+	};
+
+	FORCEINLINE const FCell& GetCell(int32 DraftIndex, int32 HeelIndex, int32 TrimIndex) const
+	{
+		return Cells[(TrimIndex * NumHeels + HeelIndex) * NumDrafts + DraftIndex];
+	}
+
+	/** Draft range covers all tabulated planes from dry to fully submerged hull */
+	float MinDraft;
+	float MaxDraft;
+
+	TArray<FCell> Cells;
+
+	TArray<FVector> WaterPlanePoints;
+};
+
+typedef TSharedPtr<const FVaOceanHydrostatics, ESPMode::ThreadSafe> FVaOceanHydrostaticsPtr;
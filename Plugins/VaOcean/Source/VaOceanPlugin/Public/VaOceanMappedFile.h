@@ -0,0 +1,41 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+/**
+ * Read-only file view. File is memory-mapped where platform allows it, so all processes
+ * on the same host share one copy of it. Other platforms get a private loaded copy.
+ */
+class VAOCEANPLUGIN_API FVaOceanMappedFile
+{
+public:
+	FVaOceanMappedFile();
+	~FVaOceanMappedFile();
+
+	/** Map whole file, previous one is closed */
+	bool Open(const FString& Filename);
+
+	/** Unmap file */
+	void Close();
+
+	/** File content, NULL if nothing is opened */
+	const uint8* GetData() const;
+
+	/** File size [bytes] */
+	int64 GetSize() const;
+
+	/** Is file shared with other processes or loaded to private memory */
+	bool IsMapped() const;
+
+private:
+	/** Mapped file view */
+	const uint8* MappedData;
+	int64 MappedSize;
+
+	/** File content for platforms without memory mapping */
+	TArray<uint8> LoadedData;
+
+	// Views can't be copied
+	FVaOceanMappedFile(const FVaOceanMappedFile&);
+	FVaOceanMappedFile& operator=(const FVaOceanMappedFile&);
+};
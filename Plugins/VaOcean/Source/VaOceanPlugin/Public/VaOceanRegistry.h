@@ -0,0 +1,95 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+class AVaOceanStateActor;
+
+/**
+ * Cached result of ocean lookup. Is reused while location stays in the same
+ * registry cell and nothing was registered or unregistered since.
+ */
+struct VAOCEANPLUGIN_API FVaOceanRegionHandle
+{
+	/** Ocean that covers cached location */
+	TWeakObjectPtr<AVaOceanStateActor> OceanStateActor;
+
+	/** Registry cell of cached location */
+	FIntPoint Cell;
+
+	/** Registry revision handle was updated with */
+	uint32 Revision;
+
+	/** Whole cell is covered by the same ocean, so lookup can be skipped inside it */
+	bool bUniformCell;
+
+	FVaOceanRegionHandle();
+};
+
+/**
+ * World-level index of ocean state actors by their regions. Bounded regions are
+ * stored in a uniform 2D grid, so "which ocean covers this XY" is a cell lookup.
+ * Unbounded oceans cover everything that isn't covered by a region with higher priority.
+ */
+class VAOCEANPLUGIN_API FVaOceanRegistry
+{
+public:
+	/** Registry of desired world, created on demand */
+	static FVaOceanRegistry& Get(UWorld* World);
+
+	/** Add ocean to index or update its region */
+	void Register(AVaOceanStateActor* OceanStateActor);
+
+	/** Remove ocean from index */
+	void Unregister(AVaOceanStateActor* OceanStateActor);
+
+	/** Ocean that covers desired XY, NULL if there is no one */
+	AVaOceanStateActor* FindOcean(const FVector& Location) const;
+
+	/** Refresh handle for desired location if it was moved to another cell or registry was changed */
+	AVaOceanStateActor* UpdateRegionHandle(FVaOceanRegionHandle& Handle, const FVector& Location) const;
+
+	/** Increases each time oceans are changed */
+	uint32 GetRevision() const;
+
+	/** Registry cell size [uu] */
+	static const float CellSize;
+
+private:
+	FVaOceanRegistry();
+
+	/** Registered ocean with cached region */
+	struct FRegion
+	{
+		TWeakObjectPtr<AVaOceanStateActor> OceanStateActor;
+		FBox2D Bounds;
+		int32 Priority;
+		bool bUnbounded;
+	};
+
+	/** Candidates of one cell, sorted by priority */
+	struct FCell
+	{
+		TArray<int32> Regions;
+		bool bUniform;
+	};
+
+	/** Cell of desired location */
+	static FIntPoint GetCell(const FVector& Location);
+
+	/** Highest priority region that contains location */
+	int32 FindRegion(const FVector& Location, const FCell* Cell) const;
+
+	/** Rebuild cells after regions were changed */
+	void RebuildIndex();
+
+	/** All registered oceans */
+	TArray<FRegion> Regions;
+
+	/** Bounded regions by cells */
+	TMap<FIntPoint, FCell> Cells;
+
+	/** Unbounded regions sorted by priority */
+	TArray<int32> UnboundedRegions;
+
+	uint32 Revision;
+};
@@ -0,0 +1,231 @@
+// Copyright 2014 Vladimir Alyamkin. All Rights Reserved.
+
+#pragma once
+
+/**
+ * Ocean surface grid tiled over the world. Is never changed after it was published,
+ * so it can be sampled from any thread.
+ */
+struct VAOCEANPLUGIN_API FVaOceanGrid
+{
+	/** Grid dimensions, both should be power of two */
+	int32 SizeX;
+	int32 SizeY;
+
+	/** Grid density in world space */
+	float TexelsPerUnitX;
+	float TexelsPerUnitY;
+
+	/** Surface displacement (dx, dy, dz) [uu] */
+	TArray<FVector> Displacements;
+
+	/** 8-bit height channel used instead of displacements by baked heightmaps: Height = Value * Scale + Bias */
+	TArray<uint8> HeightBytes;
+	float HeightBytesScale;
+	float HeightBytesBias;
+
+	/**
+	 * Precomputed height gradient (dz/dx, dz/dy). If empty, byte heightmaps use central differences of neighbour heights
+	 * and other grids use analytic gradient of bilinear patch.
+	 */
+	TArray<FVector2D> Gradients;
+
+	/** Surface velocity [uu per ocean sec]. Considered as zero if empty. */
+	TArray<FVector> Velocities;
+
+	/** Average height, travelling grid waves oscillate around it */
+	float MeanHeight;
+
+	FVaOceanGrid();
+
+	/** Setup grid dimensions covering desired world area */
+	void Init(int32 InSizeX, int32 InSizeY, float WorldSizeX, float WorldSizeY);
+
+	/** Height at grid texel */
+	FORCEINLINE float GetHeight(int32 Index) const
+	{
+		return HeightBytes.Num() > 0 ? HeightBytes[Index] * HeightBytesScale + HeightBytesBias : Displacements[Index].Z;
+	}
+
+	/** Central difference of heights at unwrapped texel coords, it's smooth across texel borders unlike bilinear patch derivatives */
+	FORCEINLINE FVector2D GetCentralGradient(int32 X, int32 Y) const
+	{
+		const int32 MaskX = SizeX - 1;
+		const int32 MaskY = SizeY - 1;
+		const int32 Row = (Y & MaskY) * SizeX;
+		const int32 Column = X & MaskX;
+
+		return FVector2D(
+			(GetHeight(Row + ((X + 1) & MaskX)) - GetHeight(Row + ((X - 1) & MaskX))) * TexelsPerUnitX * 0.5f,
+			(GetHeight(((Y + 1) & MaskY) * SizeX + Column) - GetHeight(((Y - 1) & MaskY) * SizeX + Column)) * TexelsPerUnitY * 0.5f);
+	}
+
+	/** Bilinear filtered height, gradient and velocity at texel coords */
+	void Sample(float TexelX, float TexelY, float& OutHeight, FVector2D& OutGradient, FVector& OutVelocity) const;
+
+	/** Bilinear filtered horizontal displacement (dx, dy) at texel coords, zero if grid has no displacements */
+	FVector2D SampleHorizontal(float TexelX, float TexelY) const;
+
+	/** Same as SampleHorizontal, for four points at once */
+	void SampleHorizontal4(const VectorRegister& TexelX, const VectorRegister& TexelY, VectorRegister& OutDx, VectorRegister& OutDy) const;
+
+	/** Same as Sample, for four points at once */
+	void Sample4(const VectorRegister& TexelX, const VectorRegister& TexelY, int32 NumLanes, float* OutHeights, FVector2D* OutGradients, FVector* OutVelocities) const;
+};
+
+typedef TSharedPtr<const FVaOceanGrid, ESPMode::ThreadSafe> FVaOceanGridPtr;
+
+
+/**
+ * One component of FFT spectrum: z = Amplitude * cos(K * X + Omega * t + Phase), it travels against K
+ */
+struct FVaOceanSpectralWave
+{
+	/** Wave vector [rad/uu] */
+	FVector2D K;
+
+	/** Angular frequency, time scale included [rad per ocean sec] */
+	float Omega;
+
+	float Phase;
+	float Amplitude;
+};
+
+
+/**
+ * Set of analytic (Gerstner) waves in SIMD friendly layout
+ */
+struct VAOCEANPLUGIN_API FVaOceanWaveSet
+{
+	/** Wave vector: k * Direction */
+	TArray<float> WaveKx;
+	TArray<float> WaveKy;
+
+	/** Angular frequency: sqrt(g * k) */
+	TArray<float> WaveOmega;
+
+	/** Initial phase */
+	TArray<float> WavePhase;
+
+	/** Amplitude */
+	TArray<float> WaveA;
+
+	/** Steepness * Amplitude * Direction: horizontal displacement */
+	TArray<float> WaveQADx;
+	TArray<float> WaveQADy;
+
+	/** k * Amplitude * Direction: slope */
+	TArray<float> WaveKADx;
+	TArray<float> WaveKADy;
+
+	/** Steepness * k * Amplitude: normal Z reduction */
+	TArray<float> WaveQKA;
+
+	/** How much fixed-point steps are done to compensate horizontal displacement */
+	int32 InverseDisplacementIterations;
+
+	FVaOceanWaveSet();
+
+	/** Build wave data from wave descriptions, TimeScale is baked into frequencies */
+	void Init(const TArray<FGerstnerWave>& Waves, int32 InInverseDisplacementIterations, float TimeScale);
+
+	/** Build wave data from FFT spectrum components, horizontal displacement is the same as FFT choppy one */
+	void InitSpectral(const TArray<FVaOceanSpectralWave>& Waves, float ChoppyScale, int32 InInverseDisplacementIterations);
+
+	/** Sum of two wave sets with amplitudes scaled by (1 - Alpha) and Alpha, used to cross-fade sea states */
+	void InitBlend(const FVaOceanWaveSet& Source, const FVaOceanWaveSet& Target, float Alpha);
+
+	/** Evaluate all waves at world XY: height [uu], normal and velocity [uu per ocean sec] */
+	void Evaluate(float X, float Y, float Time, float& OutHeight, FVector& OutNormal, FVector& OutVelocity) const;
+};
+
+typedef TSharedPtr<const FVaOceanWaveSet, ESPMode::ThreadSafe> FVaOceanWaveSetPtr;
+
+
+/**
+ * Band-limited copy of FFT cascades for physics
+ */
+struct VAOCEANPLUGIN_API FVaOceanPhysicsLOD
+{
+	/** Shortest wave length kept by LOD [uu] */
+	float MinWaveLength;
+
+	/** Cascades from the longest waves to the shortest ones */
+	TArray<FVaOceanGridPtr> CascadeGrids;
+
+	FVaOceanPhysicsLOD();
+};
+
+
+/**
+ * Immutable per-frame state of the ocean. Contains everything that is needed to sample the surface,
+ * so it can be used by worker threads without any UObject access.
+ */
+struct VAOCEANPLUGIN_API FVaOceanSnapshot
+{
+	/** Frame number snapshot was published on */
+	uint32 FrameNumber;
+
+	/** Ocean clock time */
+	float Time;
+
+	/** Ocean time speed relative to world time, converts velocities to world seconds */
+	float TimeRate;
+
+	/** Zero ocean level */
+	float OceanLevel;
+
+	/** Surface grid, can be shared between snapshots */
+	FVaOceanGridPtr Grid;
+
+	/** Grid texel offset (panner) */
+	float GridOffsetX;
+	float GridOffsetY;
+
+	/** Travel velocity of the whole grid pattern (panner) [uu per ocean sec] */
+	FVector GridPhaseVelocity;
+
+	/** Dominant wave number of travelling grid, used to get orbital velocity from height */
+	float GridWaveNumber;
+
+	/** FFT cascades sorted from the longest waves to the shortest ones, their sum is added to the grid */
+	TArray<FVaOceanGridPtr> CascadeGrids;
+
+	/** Fixed-point steps that compensate horizontal (choppy) displacement of cascades */
+	int32 CascadeInverseIterations;
+
+	/** Physics LODs of cascades from the finest one to the coarsest one */
+	TArray<FVaOceanPhysicsLOD> PhysicsLODs;
+
+	/** Analytic waves added to the grid */
+	FVaOceanWaveSetPtr WaveSet;
+
+	/** Baked looping animation added to the grid, blended between two frames */
+	FVaOceanBakedAnimationPtr BakedAnimation;
+	int32 BakedFrameA;
+	int32 BakedFrameB;
+	float BakedFrameAlpha;
+
+	FVaOceanSnapshot();
+
+	/**
+	 * Ocean level, unit surface normal and wave velocity [m/sec] at world location.
+	 * MaxCascades limits FFT cascades to the long waves, physics usually doesn't need short ones.
+	 * PhysicsLOD replaces cascades with their band-limited copy (INDEX_NONE is full resolution).
+	 */
+	void Sample(const FVector& Location, float& OutLevel, FVector& OutNormal, FVector& OutVelocity, int32 MaxCascades = MAX_int32, int32 PhysicsLOD = INDEX_NONE) const;
+
+	/** Same as Sample, for many locations at once */
+	void SampleBatch(const TArray<FVector>& Locations, TArray<float>& OutLevels, TArray<FVector>& OutNormals, TArray<FVector>& OutVelocities, int32 MaxCascades = MAX_int32, int32 PhysicsLOD = INDEX_NONE) const;
+
+	/** Same as SampleBatch, for a range of caller's buffers */
+	void SampleBatch(const FVector* Locations, int32 NumLocations, float* OutLevels, FVector* OutNormals, FVector* OutVelocities, int32 MaxCascades = MAX_int32, int32 PhysicsLOD = INDEX_NONE) const;
+
+	/** The coarsest physics LOD that still keeps waves of desired length (e.g. hull length), INDEX_NONE if there is no one */
+	int32 FindPhysicsLOD(float WaveLength) const;
+
+	/** Cascades of desired physics LOD */
+	const TArray<FVaOceanGridPtr>& GetCascadeGrids(int32 PhysicsLOD) const;
+};
+
+typedef TSharedPtr<const FVaOceanSnapshot, ESPMode::ThreadSafe> FVaOceanSnapshotPtr;